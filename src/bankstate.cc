@@ -3,23 +3,9 @@
 namespace dramsim3 {
 
 BankState::BankState()
-    : state_(State::CLOSED),
-      cmd_timing_(static_cast<int>(CommandType::SIZE)),
-      open_row_(-1),
-      row_hit_count_(0) {
-    cmd_timing_[static_cast<int>(CommandType::READ)] = 0;
-    cmd_timing_[static_cast<int>(CommandType::READ_PRECHARGE)] = 0;
-    cmd_timing_[static_cast<int>(CommandType::WRITE)] = 0;
-    cmd_timing_[static_cast<int>(CommandType::WRITE_PRECHARGE)] = 0;
-    cmd_timing_[static_cast<int>(CommandType::ACTIVATE)] = 0;
-    cmd_timing_[static_cast<int>(CommandType::PRECHARGE)] = 0;
-    cmd_timing_[static_cast<int>(CommandType::REFRESH)] = 0;
-    cmd_timing_[static_cast<int>(CommandType::SREF_ENTER)] = 0;
-    cmd_timing_[static_cast<int>(CommandType::SREF_EXIT)] = 0;
-}
-
+    : state_(State::CLOSED), open_row_(-1), row_hit_count_(0) {}
 
-Command BankState::GetReadyCommand(const Command& cmd, uint64_t clk) const {
+CommandType BankState::RequiredCommand(const Command& cmd) const {
     CommandType required_type = CommandType::SIZE;
     switch (state_) {
         case State::CLOSED:
@@ -84,13 +70,7 @@ Command BankState::GetReadyCommand(const Command& cmd, uint64_t clk) const {
             AbruptExit(__FILE__, __LINE__);
             break;
     }
-
-    if (required_type != CommandType::SIZE) {
-        if (clk >= cmd_timing_[static_cast<int>(required_type)]) {
-            return Command(required_type, cmd.addr, cmd.hex_addr);
-        }
-    }
-    return Command();
+    return required_type;
 }
 
 void BankState::UpdateState(const Command& cmd) {
@@ -164,10 +144,4 @@ void BankState::UpdateState(const Command& cmd) {
     return;
 }
 
-void BankState::UpdateTiming(CommandType cmd_type, uint64_t time) {
-    cmd_timing_[static_cast<int>(cmd_type)] =
-        std::max(cmd_timing_[static_cast<int>(cmd_type)], time);
-    return;
-}
-
 }  // namespace dramsim3
@@ -11,14 +11,13 @@ class BankState {
     BankState();
 
     enum class State { OPEN, CLOSED, SREF, PD, SIZE };
-    Command GetReadyCommand(const Command& cmd, uint64_t clk) const;
+    // the command this bank has to issue next on the way to `cmd`, its
+    // timing is kept by ChannelState
+    CommandType RequiredCommand(const Command& cmd) const;
 
     // Update the state of the bank resulting after the execution of the command
     void UpdateState(const Command& cmd);
 
-    // Update the existing timing constraints for the command
-    void UpdateTiming(const CommandType cmd_type, uint64_t time);
-
     bool IsRowOpen() const { return state_ == State::OPEN; }
     int OpenRow() const { return open_row_; }
     int RowHitCount() const { return row_hit_count_; }
@@ -28,9 +27,6 @@ class BankState {
     // Apriori or instantaneously transitions on a command.
     State state_;
 
-    // Earliest time when the particular Command can be executed in this bank
-    std::vector<uint64_t> cmd_timing_;
-
     // Currently open row
     int open_row_;
 
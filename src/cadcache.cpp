@@ -63,6 +63,64 @@ int Tag::utilized() {
     return std::count(accessed.begin(), accessed.end(), true);
 }
 
+void Tag::Save(StateWriter &w) const {
+    w.Put(tag);
+    w.Put(valid);
+    w.Put(dirty);
+    w.Put(granularity);
+    w.Put(accessed);
+    w.Put(dirty_bits);
+    w.Put(sub_valid);
+    w.Put(sub_tag);
+}
+
+bool Tag::Load(StateReader &r) {
+    r.Get(tag);
+    r.Get(valid);
+    r.Get(dirty);
+    r.Get(granularity);
+    r.Get(accessed);
+    r.Get(dirty_bits);
+    r.Get(sub_valid);
+    return r.Get(sub_tag);
+}
+
+bool Tag::IsClear() const {
+    return tag == 0 && !valid && !dirty && sub_valid.empty() && sub_tag.empty() &&
+           std::find(accessed.begin(), accessed.end(), true) == accessed.end() &&
+           std::find(dirty_bits.begin(), dirty_bits.end(), true) == dirty_bits.end();
+}
+
+void Tag::SaveAll(StateWriter &w, const std::vector<Tag> &tags) {
+    uint64_t n = 0;
+    for (auto &t : tags) {
+        n += t.IsClear() ? 0 : 1;
+    }
+    w.Put<uint64_t>(tags.size());
+    w.Put(n);
+    for (uint64_t i = 0; i < tags.size(); i++) {
+        if(tags[i].IsClear())
+            continue;
+        w.Put(i);
+        tags[i].Save(w);
+    }
+}
+
+bool Tag::LoadAll(StateReader &r, std::vector<Tag> &tags) {
+    uint64_t size = 0, n = 0, i = 0;
+    if(!r.Get(size) || size != tags.size() || !r.Get(n))
+        return false;
+    for (auto &t : tags) {
+        if(!t.IsClear())
+            t = Tag(0, false, false, t.granularity);
+    }
+    while(n-- && r.Get(i)){
+        if(i >= tags.size() || !tags[i].Load(r))
+            return false;
+    }
+    return r.Ok();
+}
+
 FrontEnd::FrontEnd(std::string output_dir, JedecDRAMSystem *cache, Config &config):
     benchmark_name(output_dir.substr(output_dir.find_last_of('/') + 1)){
     cache_ = cache;
@@ -97,6 +155,14 @@ bool FrontEnd::GetResp(uint64_t &req_id) {
     return false;
 }
 
+void FrontEnd::SaveState(StateWriter &w) const {
+    Tag::SaveAll(w, Meta_SRAM);
+}
+
+bool FrontEnd::LoadState(StateReader &r) {
+    return Tag::LoadAll(r, Meta_SRAM);
+}
+
 void FrontEnd::Drained() {
     if(!front_q.empty()){
         LSQ.emplace_back(RemoteRequest(front_q.front().second,
@@ -107,6 +173,15 @@ void FrontEnd::Drained() {
     }
 }
 
+uint64_t FrontEnd::NextEventCycle() const {
+    uint64_t clk = GetCLK();
+    if(!LSQ.empty() || !front_q.empty())
+        return clk;
+    if(!resp.empty())
+        return std::max(resp.front().second, clk);
+    return UINT64_MAX;
+}
+
 bool FrontEnd::AddTransaction(uint64_t hex_addr, bool is_write) {
     front_q.emplace_back(std::make_pair(hex_addr, is_write));
     return true;
@@ -202,6 +277,37 @@ void cadcache::WarmUp(uint64_t hex_addr, bool is_write) {
     cache_controller->WarmUp(hex_addr, is_write);
 }
 
+void cadcache::SaveState(StateWriter &w) const {
+    cache_controller->SaveState(w);
+}
+
+bool cadcache::LoadState(StateReader &r) {
+    return cache_controller->LoadState(r);
+}
+
+uint64_t cadcache::NextEventCycle() const {
+    if(req_.sz != 0)
+        return clk_;
+    uint64_t next = std::min(cache_controller->NextEventCycle(),
+                             egress_link.NextEventCycle());
+    if(!write_buffer.empty())
+        next = std::min(next, write_buffer.front().second);
+    if(next > clk_)
+        next = std::min(next, JedecDRAMSystem::NextEventCycle());
+    if(next > clk_)
+        next = std::min(next, remote_memory.NextEventCycle());
+    return std::max(next, clk_);
+}
+
+void cadcache::FastForward(uint64_t clk) {
+    JedecDRAMSystem::FastForward(clk);
+    remote_memory.FastForward(clk);
+}
+
+void cadcache::GetCacheStat(uint64_t &hit, uint64_t &miss) const {
+    cache_controller->GetStat(hit, miss);
+}
+
 void cadcache::RemoteCallback(uint64_t req_id) {
     cache_controller->Refill(req_id);
 }
@@ -262,6 +368,17 @@ void MemoryPool::ClockTick() {
     JedecDRAMSystem::ClockTick();
 }
 
+uint64_t MemoryPool::NextEventCycle() const {
+    if(!flits_issue.empty())
+        return clk_;
+    return std::max(std::min(egress_link.NextEventCycle(),
+                             JedecDRAMSystem::NextEventCycle()), clk_);
+}
+
+void MemoryPool::FastForward(uint64_t clk) {
+    JedecDRAMSystem::FastForward(clk);
+}
+
 bool MemoryPool::WillAcceptTransaction(RemoteRequest req) {
     return true;
 }
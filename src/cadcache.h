@@ -11,6 +11,7 @@
 #include "controller.h"
 #include "timing.h"
 #include "dram_system.h"
+#include "checkpoint.h"
 
 namespace dramsim3{
 
@@ -31,12 +32,16 @@ class Ethernet{
     Ethernet(Config &config);
     bool AddTransaction(pktType req, uint64_t clk, uint64_t req_sz);
     bool GetReq(pktType &req, uint64_t clk);
+    //exit time of the next packet, UINT64_MAX if the link is empty
+    uint64_t NextEventCycle() const {
+        return ethernet.empty() ? UINT64_MAX : ethernet.front().exit_time;
+    };
     void PrintStat();
 };
 
 class RemoteRequest {
    public:
-    RemoteRequest(){};
+    RemoteRequest(): hex_addr(0), sz(0), is_write(false), exit_time(0){};
     RemoteRequest(bool is_write_, uint64_t hex_addr_, int sz_, uint64_t exit_time_);
     uint64_t hex_addr;
     int sz; //number of 64B flits
@@ -61,6 +66,8 @@ class MemoryPool : public JedecDRAMSystem{
     bool WillAcceptTransaction(RemoteRequest req);
     bool AddTransaction(RemoteRequest req);
     void ClockTick() override;
+    uint64_t NextEventCycle() const override;
+    void FastForward(uint64_t clk) override;
 
 };
 
@@ -99,6 +106,13 @@ class Tag {
     Tag(uint64_t tag_, bool valid_, bool dirty_, uint64_t granularity_);
     Tag(){};
     int utilized();
+    void Save(StateWriter &w) const;
+    bool Load(StateReader &r);
+    //as constructed with this granularity
+    bool IsClear() const;
+    //only the tags that are not clear are written
+    static void SaveAll(StateWriter &w, const std::vector<Tag> &tags);
+    static bool LoadAll(StateReader &r, std::vector<Tag> &tags);
     //used in our
     std::vector<bool> sub_valid;
     std::vector<uint8_t> sub_tag;
@@ -115,7 +129,7 @@ class FrontEnd {
     std::vector<Tag> Meta_SRAM;
     std::list<std::pair<uint64_t, bool>> front_q;
 
-    uint64_t GetCLK(){ return cache_->clk_; }
+    uint64_t GetCLK() const { return cache_->clk_; }
 
     public:
     FrontEnd(std::string output_dir, JedecDRAMSystem *cache, Config &config);
@@ -131,6 +145,13 @@ class FrontEnd {
     virtual void WarmUp(uint64_t hex_addr, bool is_write) {};
     virtual void PrintStat() {};
     virtual void ResetStat() {};
+    virtual void GetStat(uint64_t &hit, uint64_t &miss) const { hit = 0; miss = 0; };
+    //the state WarmUp() builds, for checkpoints of warmed caches
+    virtual void SaveState(StateWriter &w) const;
+    virtual bool LoadState(StateReader &r);
+    //first cache clock at which the frontend has work, the current clock
+    //if it is busy
+    virtual uint64_t NextEventCycle() const;
 };
 
 class cadcache : public JedecDRAMSystem {
@@ -159,6 +180,11 @@ class cadcache : public JedecDRAMSystem {
     void PrintStats() override;
     void ResetStats() override;
     void WarmUp(uint64_t hex_addr, bool is_write);
+    void SaveState(StateWriter &w) const;
+    bool LoadState(StateReader &r);
+    uint64_t NextEventCycle() const override;
+    void FastForward(uint64_t clk) override;
+    void GetCacheStat(uint64_t &hit, uint64_t &miss) const;
 };
 
 }
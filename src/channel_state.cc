@@ -2,35 +2,16 @@
 
 namespace dramsim3 {
 ChannelState::ChannelState(const Config& config, const Timing& timing)
-    : rank_idle_cycles(config.ranks, 0),
-      config_(config),
+    : config_(config),
       timing_(timing),
       rank_is_sref_(config.ranks, false),
+      num_banks_(config.ranks * config.banks),
+      bank_states_(num_banks_, BankState()),
+      rank_open_banks_(config.ranks, 0),
+      cmd_timing_(static_cast<int>(CommandType::SIZE) * num_banks_, 0),
+      updates_(0),
       four_aw_(config_.ranks, std::vector<uint64_t>()),
-      thirty_two_aw_(config_.ranks, std::vector<uint64_t>()) {
-    bank_states_.reserve(config_.ranks);
-    for (auto i = 0; i < config_.ranks; i++) {
-        auto rank_states = std::vector<std::vector<BankState>>();
-        rank_states.reserve(config_.bankgroups);
-        for (auto j = 0; j < config_.bankgroups; j++) {
-            auto bg_states =
-                std::vector<BankState>(config_.banks_per_group, BankState());
-            rank_states.push_back(bg_states);
-        }
-        bank_states_.push_back(rank_states);
-    }
-}
-
-bool ChannelState::IsAllBankIdleInRank(int rank) const {
-    for (int j = 0; j < config_.bankgroups; j++) {
-        for (int k = 0; k < config_.banks_per_group; k++) {
-            if (bank_states_[rank][j][k].IsRowOpen()) {
-                return false;
-            }
-        }
-    }
-    return true;
-}
+      thirty_two_aw_(config_.ranks, std::vector<uint64_t>()) {}
 
 bool ChannelState::IsRWPendingOnRef(const Command& cmd) const {
     int rank = cmd.Rank();
@@ -38,7 +19,16 @@ bool ChannelState::IsRWPendingOnRef(const Command& cmd) const {
     int bank = cmd.Bank();
     return (IsRowOpen(rank, bankgroup, bank) &&
             RowHitCount(rank, bankgroup, bank) == 0 &&
-            bank_states_[rank][bankgroup][bank].OpenRow() == cmd.Row());
+            OpenRow(rank, bankgroup, bank) == cmd.Row());
+}
+
+bool ChannelState::IsRefreshPending(int rank) const {
+    for (const auto& ref : refresh_q_) {
+        if (ref.Rank() == rank) {
+            return true;
+        }
+    }
+    return false;
 }
 
 void ChannelState::BankNeedRefresh(int rank, int bankgroup, int bank,
@@ -73,35 +63,53 @@ void ChannelState::RankNeedRefresh(int rank, bool need) {
     return;
 }
 
+Command ChannelState::GetReadyBankCommand(const Command& cmd, int bank,
+                                          uint64_t clk) const {
+    CommandType required_type = bank_states_[bank].RequiredCommand(cmd);
+    if (required_type != CommandType::SIZE &&
+        clk >= CommandTiming(required_type)[bank]) {
+        return Command(required_type, cmd.addr, cmd.hex_addr);
+    }
+    return Command();
+}
+
 Command ChannelState::GetReadyCommand(const Command& cmd, uint64_t clk) const {
     Command ready_cmd = Command();
     if (cmd.IsRankCMD()) {
-        int num_ready = 0;
-        for (auto j = 0; j < config_.bankgroups; j++) {
-            for (auto k = 0; k < config_.banks_per_group; k++) {
-                ready_cmd =
-                    bank_states_[cmd.Rank()][j][k].GetReadyCommand(cmd, clk);
-                if (!ready_cmd.IsValid()) {  // Not ready
-                    continue;
-                }
-                if (ready_cmd.cmd_type != cmd.cmd_type) {  // likely PRECHARGE
-                    Address new_addr = Address(-1, cmd.Rank(), j, k, -1, -1);
-                    ready_cmd.addr = new_addr;
-                    return ready_cmd;
-                } else {
-                    num_ready++;
-                }
+        int begin = cmd.Rank() * config_.banks;
+        int end = begin + config_.banks;
+        bool all_same = true;
+        for (int b = begin; b < end; b++) {
+            CommandType required_type = bank_states_[b].RequiredCommand(cmd);
+            if (required_type == cmd.cmd_type) {
+                continue;
+            }
+            all_same = false;
+            // likely PRECHARGE
+            if (required_type != CommandType::SIZE &&
+                clk >= CommandTiming(required_type)[b]) {
+                int j = (b - begin) / config_.banks_per_group;
+                int k = (b - begin) % config_.banks_per_group;
+                Address new_addr = Address(-1, cmd.Rank(), j, k, -1, -1);
+                return Command(required_type, new_addr, cmd.hex_addr);
             }
         }
-        // All bank ready
-        if (num_ready == config_.banks) {
-            return ready_cmd;
-        } else {
+        if (!all_same) {
             return Command();
         }
+        // All bank ready: one compare per bank, no early exit
+        const uint64_t* timing = CommandTiming(cmd.cmd_type);
+        uint64_t latest = 0;
+        for (int b = begin; b < end; b++) {
+            latest = std::max(latest, timing[b]);
+        }
+        if (clk >= latest) {
+            return Command(cmd.cmd_type, cmd.addr, cmd.hex_addr);
+        }
+        return Command();
     } else {
-        ready_cmd = bank_states_[cmd.Rank()][cmd.Bankgroup()][cmd.Bank()]
-                        .GetReadyCommand(cmd, clk);
+        ready_cmd = GetReadyBankCommand(
+            cmd, BankIndex(cmd.Rank(), cmd.Bankgroup(), cmd.Bank()), clk);
         if (!ready_cmd.IsValid()) {
             return Command();
         }
@@ -114,12 +122,31 @@ Command ChannelState::GetReadyCommand(const Command& cmd, uint64_t clk) const {
     }
 }
 
+uint64_t ChannelState::ReadyCycle(const Command& cmd, uint64_t clk) const {
+    if (cmd.IsRankCMD()) {
+        return clk;
+    }
+    int bank = BankIndex(cmd.Rank(), cmd.Bankgroup(), cmd.Bank());
+    CommandType required_type = bank_states_[bank].RequiredCommand(cmd);
+    if (required_type == CommandType::SIZE) {
+        return UINT64_MAX;
+    }
+    uint64_t ready = CommandTiming(required_type)[bank];
+    if (required_type == CommandType::ACTIVATE) {
+        ready = std::max(ready, ActivationWindowCycle(cmd.Rank()));
+    }
+    return std::max(ready, clk);
+}
+
 void ChannelState::UpdateState(const Command& cmd) {
+    updates_++;
+    int &open_banks = rank_open_banks_[cmd.Rank()];
     if (cmd.IsRankCMD()) {
-        for (auto j = 0; j < config_.bankgroups; j++) {
-            for (auto k = 0; k < config_.banks_per_group; k++) {
-                bank_states_[cmd.Rank()][j][k].UpdateState(cmd);
-            }
+        for (int b = cmd.Rank() * config_.banks;
+             b < (cmd.Rank() + 1) * config_.banks; b++) {
+            open_banks -= bank_states_[b].IsRowOpen();
+            bank_states_[b].UpdateState(cmd);
+            open_banks += bank_states_[b].IsRowOpen();
         }
         if (cmd.IsRefresh()) {
             RankNeedRefresh(cmd.Rank(), false);
@@ -129,7 +156,11 @@ void ChannelState::UpdateState(const Command& cmd) {
             rank_is_sref_[cmd.Rank()] = false;
         }
     } else {
-        bank_states_[cmd.Rank()][cmd.Bankgroup()][cmd.Bank()].UpdateState(cmd);
+        BankState &bank_state =
+            bank_states_[BankIndex(cmd.Rank(), cmd.Bankgroup(), cmd.Bank())];
+        open_banks -= bank_state.IsRowOpen();
+        bank_state.UpdateState(cmd);
+        open_banks += bank_state.IsRowOpen();
         if (cmd.IsRefresh()) {
             BankNeedRefresh(cmd.Rank(), cmd.Bankgroup(), cmd.Bank(), false);
         }
@@ -138,6 +169,7 @@ void ChannelState::UpdateState(const Command& cmd) {
 }
 
 void ChannelState::UpdateTiming(const Command& cmd, uint64_t clk) {
+    updates_++;
     switch (cmd.cmd_type) {
         case CommandType::ACTIVATE:
             UpdateActivationTimes(cmd.Rank(), clk);
@@ -185,29 +217,38 @@ void ChannelState::UpdateTiming(const Command& cmd, uint64_t clk) {
     return;
 }
 
-void ChannelState::UpdateSameBankTiming(
-    const Address& addr,
+void ChannelState::UpdateBanksTiming(
+    int begin, int end,
     const std::vector<std::pair<CommandType, int>>& cmd_timing_list,
     uint64_t clk) {
     for (auto cmd_timing : cmd_timing_list) {
-        bank_states_[addr.rank][addr.bankgroup][addr.bank].UpdateTiming(
-            cmd_timing.first, clk + cmd_timing.second);
+        uint64_t* timing = CommandTiming(cmd_timing.first);
+        uint64_t time = clk + cmd_timing.second;
+        for (int b = begin; b < end; b++) {
+            timing[b] = std::max(timing[b], time);
+        }
     }
     return;
 }
 
+void ChannelState::UpdateSameBankTiming(
+    const Address& addr,
+    const std::vector<std::pair<CommandType, int>>& cmd_timing_list,
+    uint64_t clk) {
+    int b = BankIndex(addr.rank, addr.bankgroup, addr.bank);
+    UpdateBanksTiming(b, b + 1, cmd_timing_list, clk);
+    return;
+}
+
 void ChannelState::UpdateOtherBanksSameBankgroupTiming(
     const Address& addr,
     const std::vector<std::pair<CommandType, int>>& cmd_timing_list,
     uint64_t clk) {
-    for (auto k = 0; k < config_.banks_per_group; k++) {
-        if (k != addr.bank) {
-            for (auto cmd_timing : cmd_timing_list) {
-                bank_states_[addr.rank][addr.bankgroup][k].UpdateTiming(
-                    cmd_timing.first, clk + cmd_timing.second);
-            }
-        }
-    }
+    int begin = BankIndex(addr.rank, addr.bankgroup, 0);
+    int b = begin + addr.bank;
+    UpdateBanksTiming(begin, b, cmd_timing_list, clk);
+    UpdateBanksTiming(b + 1, begin + config_.banks_per_group, cmd_timing_list,
+                      clk);
     return;
 }
 
@@ -215,16 +256,11 @@ void ChannelState::UpdateOtherBankgroupsSameRankTiming(
     const Address& addr,
     const std::vector<std::pair<CommandType, int>>& cmd_timing_list,
     uint64_t clk) {
-    for (auto j = 0; j < config_.bankgroups; j++) {
-        if (j != addr.bankgroup) {
-            for (auto k = 0; k < config_.banks_per_group; k++) {
-                for (auto cmd_timing : cmd_timing_list) {
-                    bank_states_[addr.rank][j][k].UpdateTiming(
-                        cmd_timing.first, clk + cmd_timing.second);
-                }
-            }
-        }
-    }
+    int begin = BankIndex(addr.rank, 0, 0);
+    int group = BankIndex(addr.rank, addr.bankgroup, 0);
+    UpdateBanksTiming(begin, group, cmd_timing_list, clk);
+    UpdateBanksTiming(group + config_.banks_per_group, begin + config_.banks,
+                      cmd_timing_list, clk);
     return;
 }
 
@@ -232,18 +268,9 @@ void ChannelState::UpdateOtherRanksTiming(
     const Address& addr,
     const std::vector<std::pair<CommandType, int>>& cmd_timing_list,
     uint64_t clk) {
-    for (auto i = 0; i < config_.ranks; i++) {
-        if (i != addr.rank) {
-            for (auto j = 0; j < config_.bankgroups; j++) {
-                for (auto k = 0; k < config_.banks_per_group; k++) {
-                    for (auto cmd_timing : cmd_timing_list) {
-                        bank_states_[i][j][k].UpdateTiming(
-                            cmd_timing.first, clk + cmd_timing.second);
-                    }
-                }
-            }
-        }
-    }
+    int rank = BankIndex(addr.rank, 0, 0);
+    UpdateBanksTiming(0, rank, cmd_timing_list, clk);
+    UpdateBanksTiming(rank + config_.banks, num_banks_, cmd_timing_list, clk);
     return;
 }
 
@@ -251,14 +278,8 @@ void ChannelState::UpdateSameRankTiming(
     const Address& addr,
     const std::vector<std::pair<CommandType, int>>& cmd_timing_list,
     uint64_t clk) {
-    for (auto j = 0; j < config_.bankgroups; j++) {
-        for (auto k = 0; k < config_.banks_per_group; k++) {
-            for (auto cmd_timing : cmd_timing_list) {
-                bank_states_[addr.rank][j][k].UpdateTiming(
-                    cmd_timing.first, clk + cmd_timing.second);
-            }
-        }
-    }
+    int rank = BankIndex(addr.rank, 0, 0);
+    UpdateBanksTiming(rank, rank + config_.banks, cmd_timing_list, clk);
     return;
 }
 
@@ -303,6 +324,17 @@ bool ChannelState::IsFAWReady(int rank, uint64_t curr_time) const {
     return true;
 }
 
+uint64_t ChannelState::ActivationWindowCycle(int rank) const {
+    uint64_t ready = 0;
+    if (four_aw_[rank].size() >= 4) {
+        ready = four_aw_[rank][0];
+    }
+    if (config_.IsGDDR() && thirty_two_aw_[rank].size() >= 32) {
+        ready = std::max(ready, thirty_two_aw_[rank][0]);
+    }
+    return ready;
+}
+
 bool ChannelState::Is32AWReady(int rank, uint64_t curr_time) const {
     if (!thirty_two_aw_[rank].empty()) {
         if (curr_time < thirty_two_aw_[rank][0] &&
@@ -13,42 +13,79 @@ class ChannelState {
    public:
     ChannelState(const Config& config, const Timing& timing);
     Command GetReadyCommand(const Command& cmd, uint64_t clk) const;
+    // first clock GetReadyCommand(cmd, clk) of a bank command is valid at
+    // until the next update, rank commands are taken as ready now
+    uint64_t ReadyCycle(const Command& cmd, uint64_t clk) const;
+    // bumped by every update of states or timing
+    uint64_t Updates() const { return updates_; }
     void UpdateState(const Command& cmd);
     void UpdateTiming(const Command& cmd, uint64_t clk);
     void UpdateTimingAndStates(const Command& cmd, uint64_t clk);
     bool ActivationWindowOk(int rank, uint64_t curr_time) const;
     void UpdateActivationTimes(int rank, uint64_t curr_time);
     bool IsRowOpen(int rank, int bankgroup, int bank) const {
-        return bank_states_[rank][bankgroup][bank].IsRowOpen();
+        return bank_states_[BankIndex(rank, bankgroup, bank)].IsRowOpen();
+    }
+    bool IsAllBankIdleInRank(int rank) const {
+        return rank_open_banks_[rank] == 0;
     }
-    bool IsAllBankIdleInRank(int rank) const;
     bool IsRankSelfRefreshing(int rank) const { return rank_is_sref_[rank]; }
     bool IsRefreshWaiting() const { return !refresh_q_.empty(); }
+    // a refresh of the rank or one of its banks is waiting
+    bool IsRefreshPending(int rank) const;
     bool IsRWPendingOnRef(const Command& cmd) const;
     const Command& PendingRefCommand() const {return refresh_q_.front(); }
     void BankNeedRefresh(int rank, int bankgroup, int bank, bool need);
     void RankNeedRefresh(int rank, bool need);
     int OpenRow(int rank, int bankgroup, int bank) const {
-        return bank_states_[rank][bankgroup][bank].OpenRow();
+        return bank_states_[BankIndex(rank, bankgroup, bank)].OpenRow();
     }
     int RowHitCount(int rank, int bankgroup, int bank) const {
-        return bank_states_[rank][bankgroup][bank].RowHitCount();
+        return bank_states_[BankIndex(rank, bankgroup, bank)].RowHitCount();
     };
 
-    std::vector<int> rank_idle_cycles;
-
    private:
     const Config& config_;
     const Timing& timing_;
 
     std::vector<bool> rank_is_sref_;
-    std::vector<std::vector<std::vector<BankState> > > bank_states_;
+    // banks are numbered rank by rank, bankgroup by bankgroup
+    int num_banks_;
+    std::vector<BankState> bank_states_;
+    // banks with an open row in each rank
+    std::vector<int> rank_open_banks_;
+    // Earliest time each command can be executed in each bank, one array
+    // of num_banks_ per CommandType so a command's timing update is a
+    // max() sweep over a contiguous range of banks
+    std::vector<uint64_t> cmd_timing_;
+    int BankIndex(int rank, int bankgroup, int bank) const {
+        return (rank * config_.bankgroups + bankgroup) *
+                   config_.banks_per_group +
+               bank;
+    }
+    uint64_t* CommandTiming(CommandType cmd_type) {
+        return &cmd_timing_[static_cast<int>(cmd_type) * num_banks_];
+    }
+    const uint64_t* CommandTiming(CommandType cmd_type) const {
+        return &cmd_timing_[static_cast<int>(cmd_type) * num_banks_];
+    }
+    // raise the timing of banks [begin, end) to clk + each list delay
+    void UpdateBanksTiming(
+        int begin, int end,
+        const std::vector<std::pair<CommandType, int> >& cmd_timing_list,
+        uint64_t clk);
+    // the command the bank needs next if it is ready at `clk`
+    Command GetReadyBankCommand(const Command& cmd, int bank,
+                                uint64_t clk) const;
     std::vector<Command> refresh_q_;
+    uint64_t updates_;
 
     std::vector<std::vector<uint64_t> > four_aw_;
     std::vector<std::vector<uint64_t> > thirty_two_aw_;
     bool IsFAWReady(int rank, uint64_t curr_time) const;
     bool Is32AWReady(int rank, uint64_t curr_time) const;
+    // first clock an ACT of the rank fits in the activation windows
+    uint64_t ActivationWindowCycle(int rank) const;
     // Update timing of the bank the command corresponds to
     void UpdateSameBankTiming(
         const Address& addr,
@@ -0,0 +1,117 @@
+#include "checkpoint.h"
+#include <string.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace dramsim3 {
+
+const char kCheckpointMagic[8] = {'H', 'M', 'T', 'T', 'C', 'K', 'P', '\0'};
+
+void CheckpointKey::Add(const void *data, size_t len) {
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < len; i++) {
+        value_ ^= p[i];
+        value_ *= 1099511628211ULL;
+    }
+}
+
+void CheckpointKey::AddFile(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+    Add(contents);
+}
+
+void CheckpointKey::AddFileSize(const std::string &path) {
+    struct stat st;
+    Add(stat(path.c_str(), &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0);
+}
+
+StateWriter::~StateWriter() {
+    if (fp_ != NULL) {
+        fclose(fp_);
+        remove(tmp_path_.c_str());
+    }
+}
+
+bool StateWriter::Open(const std::string &path, uint64_t key, uint64_t trace_id) {
+    path_ = path;
+    tmp_path_ = path + ".tmp";
+    fp_ = fopen(tmp_path_.c_str(), "wb");
+    if (fp_ == NULL) {
+        std::cerr << "cannot create checkpoint " << tmp_path_ << std::endl;
+        return false;
+    }
+    CheckpointHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kCheckpointMagic, sizeof(kCheckpointMagic));
+    header.version = kCheckpointVersion;
+    header.key = key;
+    header.trace_id = trace_id;
+    Put(header);
+    return true;
+}
+
+bool StateWriter::Close() {
+    bool ok = ferror(fp_) == 0;
+    ok = fclose(fp_) == 0 && ok;
+    fp_ = NULL;
+    // segments simulated in parallel may share the checkpoint directory,
+    // a reader sees either no checkpoint or a complete one
+    if (!ok || rename(tmp_path_.c_str(), path_.c_str()) != 0) {
+        std::cerr << "cannot write checkpoint " << path_ << std::endl;
+        remove(tmp_path_.c_str());
+        return false;
+    }
+    return true;
+}
+
+void StateWriter::Put(const std::vector<bool> &v) {
+    std::vector<uint8_t> bits((v.size() + 7) / 8, 0);
+    for (size_t i = 0; i < v.size(); i++) {
+        if (v[i]) bits[i / 8] |= 1 << (i % 8);
+    }
+    Put<uint64_t>(v.size());
+    fwrite(bits.data(), 1, bits.size(), fp_);
+}
+
+StateReader::~StateReader() { Close(); }
+
+void StateReader::Close() {
+    if (fp_ != NULL) {
+        fclose(fp_);
+        fp_ = NULL;
+    }
+}
+
+bool StateReader::Open(const std::string &path, uint64_t key) {
+    fp_ = fopen(path.c_str(), "rb");
+    if (fp_ == NULL) {
+        return false;
+    }
+    if (!Get(header_) ||
+        memcmp(header_.magic, kCheckpointMagic, sizeof(kCheckpointMagic)) != 0 ||
+        header_.version != kCheckpointVersion || header_.key != key) {
+        std::cerr << path << " is not a version " << kCheckpointVersion
+                  << " checkpoint of this segment, ignored" << std::endl;
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool StateReader::Get(std::vector<bool> &v) {
+    uint64_t n = 0;
+    if (!Get(n)) return false;
+    std::vector<uint8_t> bits((n + 7) / 8);
+    ok_ = fread(bits.data(), 1, bits.size(), fp_) == bits.size();
+    v.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        v[i] = (bits[i / 8] >> (i % 8)) & 1;
+    }
+    return ok_;
+}
+
+}  // namespace dramsim3
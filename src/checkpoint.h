@@ -0,0 +1,151 @@
+#ifndef DRAMSIM3_CHECKPOINT_H
+#define DRAMSIM3_CHECKPOINT_H
+#include <stdio.h>
+#include <algorithm>
+#include <list>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace dramsim3 {
+
+// Warmed cache state (.ckpt) of an HMTT segment. The header carries a key
+// hashing everything the warm-up depends on (trace, segment, warm-up
+// start, config), a checkpoint of another key is not loaded. The body is
+// the trace reader position followed by the DRAM cache front end, written
+// by the classes themselves through StateWriter/StateReader.
+struct CheckpointHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t key;
+    uint64_t trace_id;
+};
+
+// FNV-1a over the inputs of a warm-up
+class CheckpointKey {
+   public:
+    CheckpointKey() : value_(14695981039346656037ULL) {}
+    void Add(const void *data, size_t len);
+    void Add(const std::string &s) { Add(s.data(), s.size()); }
+    void Add(uint64_t v) { Add(&v, sizeof(v)); }
+    // contents of a small file, e.g. the config
+    void AddFile(const std::string &path);
+    void AddFileSize(const std::string &path);
+    uint64_t Value() const { return value_; }
+
+   private:
+    uint64_t value_;
+};
+
+class StateWriter {
+   public:
+    StateWriter() : fp_(NULL) {}
+    ~StateWriter();
+    // written to a temporary file, Close() moves it to `path`
+    bool Open(const std::string &path, uint64_t key, uint64_t trace_id);
+    bool Close();
+    FILE *File() const { return fp_; }
+
+    template <typename T>
+    void Put(const T &v) {
+        static_assert(std::is_trivially_copyable<T>::value, "raw copy only");
+        fwrite(&v, sizeof(T), 1, fp_);
+    }
+    template <typename T>
+    void Put(const std::vector<T> &v) {
+        static_assert(std::is_trivially_copyable<T>::value, "raw copy only");
+        Put<uint64_t>(v.size());
+        fwrite(v.data(), sizeof(T), v.size(), fp_);
+    }
+    void Put(const std::vector<bool> &v);
+    // (index, entry) of the entries `keep` accepts, most of a cache is empty
+    template <typename T, typename Pred>
+    void PutSparse(const std::vector<T> &v, Pred keep) {
+        uint64_t n = 0;
+        for (auto &i : v) n += keep(i) ? 1 : 0;
+        Put<uint64_t>(v.size());
+        Put(n);
+        for (uint64_t i = 0; i < v.size(); i++) {
+            if (!keep(v[i])) continue;
+            Put(i);
+            Put(v[i]);
+        }
+    }
+    template <typename T>
+    void Put(const std::list<T> &v) {
+        Put<uint64_t>(v.size());
+        for (auto &i : v) Put(i);
+    }
+
+   private:
+    FILE *fp_;
+    std::string path_;
+    std::string tmp_path_;
+};
+
+class StateReader {
+   public:
+    StateReader() : fp_(NULL), ok_(true) {}
+    ~StateReader();
+    // false if there is no checkpoint of `key`
+    bool Open(const std::string &path, uint64_t key);
+    void Close();
+    FILE *File() const { return fp_; }
+    const CheckpointHeader &Header() const { return header_; }
+    // false once a read failed
+    bool Ok() const { return ok_; }
+    void Fail() { ok_ = false; }
+
+    template <typename T>
+    bool Get(T &v) {
+        static_assert(std::is_trivially_copyable<T>::value, "raw copy only");
+        ok_ = ok_ && fread(&v, sizeof(T), 1, fp_) == 1;
+        return ok_;
+    }
+    template <typename T>
+    bool Get(std::vector<T> &v) {
+        static_assert(std::is_trivially_copyable<T>::value, "raw copy only");
+        uint64_t n = 0;
+        if (!Get(n)) return false;
+        v.resize(n);
+        ok_ = fread(v.data(), sizeof(T), n, fp_) == n;
+        return ok_;
+    }
+    bool Get(std::vector<bool> &v);
+    // the other entries become `blank`, the size must match the vector's
+    template <typename T>
+    bool GetSparse(std::vector<T> &v, const T &blank) {
+        uint64_t size = 0, n = 0, i = 0;
+        if (!Get(size) || size != v.size() || !Get(n)) return ok_ = false;
+        std::fill(v.begin(), v.end(), blank);
+        while (n-- && Get(i)) {
+            if (i >= v.size()) return ok_ = false;
+            Get(v[i]);
+        }
+        return ok_;
+    }
+    template <typename T>
+    bool Get(std::list<T> &v) {
+        uint64_t n = 0;
+        v.clear();
+        if (!Get(n)) return false;
+        while (n-- && ok_) {
+            T i;
+            Get(i);
+            v.push_back(i);
+        }
+        return ok_;
+    }
+
+   private:
+    FILE *fp_;
+    bool ok_;
+    CheckpointHeader header_;
+};
+
+const uint32_t kCheckpointVersion = 1;
+extern const char kCheckpointMagic[8];
+
+}  // namespace dramsim3
+#endif  // DRAMSIM3_CHECKPOINT_H
@@ -9,10 +9,14 @@ CommandQueue::CommandQueue(int channel_id, const Config& config,
       config_(config),
       channel_state_(channel_state),
       simple_stats_(simple_stats),
+      ondemand_pres_stat_(simple_stats.CounterId("num_ondemand_pres")),
       is_in_ref_(false),
       queue_size_(static_cast<size_t>(config_.cmd_queue_size)),
       queue_idx_(0),
-      clk_(0) {
+      clk_(0),
+      ready_valid_(false),
+      ready_updates_(0),
+      next_ready_(0) {
     if (config_.queue_structure == "PER_BANK") {
         queue_structure_ = QueueStructure::PER_BANK;
         num_queues_ = config_.banks * config_.ranks;
@@ -34,6 +38,11 @@ CommandQueue::CommandQueue(int channel_id, const Config& config,
 }
 
 Command CommandQueue::GetCommandToIssue() {
+    // every queue would be probed in vain, the round-robin index ends up
+    // where it started either way
+    if (NextReadyCycle() > clk_) {
+        return Command();
+    }
     for (int i = 0; i < num_queues_; i++) {
         auto& queue = GetNextQueue();
         // if we're refresing, skip the command queues that are involved
@@ -103,7 +112,7 @@ bool CommandQueue::ArbitratePrecharge(const CMDIterator& cmd_it,
         channel_state_.RowHitCount(cmd.Rank(), cmd.Bankgroup(), cmd.Bank()) >=
         4;
     if (!pending_row_hits_exist || rowhit_limit_reached) {
-        simple_stats_.Increment("num_ondemand_pres");
+        simple_stats_.Increment(ondemand_pres_stat_);
         return true;
     }
     return false;
@@ -124,10 +133,30 @@ bool CommandQueue::QueueEmpty() const {
 }
 
 
+uint64_t CommandQueue::NextReadyCycle() const {
+    if (!ready_valid_ || ready_updates_ != channel_state_.Updates()) {
+        next_ready_ = UINT64_MAX;
+        for (const auto& queue : queues_) {
+            for (const auto& cmd : queue) {
+                next_ready_ =
+                    std::min(next_ready_, channel_state_.ReadyCycle(cmd, 0));
+            }
+        }
+        ready_valid_ = true;
+        ready_updates_ = channel_state_.Updates();
+    }
+    return next_ready_ == UINT64_MAX ? next_ready_
+                                     : std::max(next_ready_, clk_);
+}
+
 bool CommandQueue::AddCommand(Command cmd) {
     auto& queue = GetQueue(cmd.Rank(), cmd.Bankgroup(), cmd.Bank());
     if (queue.size() < queue_size_) {
         queue.push_back(cmd);
+        if (ready_valid_) {
+            next_ready_ =
+                std::min(next_ready_, channel_state_.ReadyCycle(cmd, 0));
+        }
         rank_q_empty[cmd.Rank()] = false;
         return true;
     } else {
@@ -135,6 +164,30 @@ bool CommandQueue::AddCommand(Command cmd) {
     }
 }
 
+bool CommandQueue::IsIdle(int rank, int bankgroup, int bank) const {
+    if (queue_structure_ == QueueStructure::PER_BANK) {
+        if (bankgroup >= 0) {
+            return queues_[GetQueueIndex(rank, bankgroup, bank)].empty();
+        }
+        for (int i = rank * config_.banks; i < (rank + 1) * config_.banks;
+             i++) {
+            if (!queues_[i].empty()) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (bankgroup < 0) {
+        return queues_[rank].empty();
+    }
+    for (const auto& cmd : queues_[rank]) {
+        if (cmd.Bankgroup() == bankgroup && cmd.Bank() == bank) {
+            return false;
+        }
+    }
+    return true;
+}
+
 CMDQueue& CommandQueue::GetNextQueue() {
     queue_idx_++;
     if (queue_idx_ == num_queues_) {
@@ -21,9 +21,15 @@ class CommandQueue {
     Command GetCommandToIssue();
     Command FinishRefresh();
     void ClockTick() { clk_ += 1; };
+    void FastForward(uint64_t cycles) { clk_ += cycles; };
     bool WillAcceptCommand(int rank, int bankgroup, int bank) const;
     bool AddCommand(Command cmd);
     bool QueueEmpty() const;
+    // no command of the rank is queued, or of the bank if bankgroup >= 0
+    bool IsIdle(int rank, int bankgroup, int bank) const;
+    // no queued command can issue before this clock (the current one if
+    // some might), UINT64_MAX if the queues are empty
+    uint64_t NextReadyCycle() const;
     int QueueUsage() const;
     std::vector<bool> rank_q_empty;
 
@@ -44,6 +50,7 @@ class CommandQueue {
     const Config& config_;
     const ChannelState& channel_state_;
     SimpleStats& simple_stats_;
+    int ondemand_pres_stat_;
 
     std::vector<CMDQueue> queues_;
 
@@ -55,6 +62,12 @@ class CommandQueue {
     size_t queue_size_;
     int queue_idx_;
     uint64_t clk_;
+
+    // earliest ready clock of the queued commands, valid while the channel
+    // state has not changed since; adding a command only lowers it
+    mutable bool ready_valid_;
+    mutable uint64_t ready_updates_;
+    mutable uint64_t next_ready_;
 };
 
 }  // namespace dramsim3
@@ -47,29 +47,6 @@ std::ostream& operator<<(std::ostream& os, const HMTTTransaction& trans){
     return os;
 }
 
-static uint64_t last_clk = 0;
-
-void GetNextHMTT(HMTTTransaction &trans, int ppid, uint64_t num_p){
-    do{
-        if(next_translate() == 0){
-            trans.valid = false;
-        }else{
-            trans.valid = true;
-        }
-
-        trans.addr = record.paddr;
-        trans.r_w = record.rw;
-        trans.is_kernel = record.vaddr == 0 && record.pid == -1;
-        trans.vaddr = record.vaddr;
-        trans.added_ns = (record.tm - last_clk) * 5;   //200MHz
-        trans.pid = record.pid;
-    }while(trans.valid &&
-            (trans.pid < ppid || trans.pid >= (ppid + num_p)) &&
-            !trans.is_kernel);
-
-    last_clk = record.tm;
-}
-
 int GetBitInPos(uint64_t bits, int pos) {
     // given a uint64_t value get the binary value of pos-th bit
     // from MSB to LSB indexed as 63 - 0
@@ -4,7 +4,6 @@
 #include <stdint.h>
 #include <iostream>
 #include <vector>
-#include "trace.h"
 
 namespace dramsim3 {
 
@@ -111,15 +110,19 @@ struct Transaction {
         : addr(addr),
           added_cycle(0),
           complete_cycle(0),
+          seq(0),
           is_write(is_write) {}
     Transaction(const Transaction& tran)
         : addr(tran.addr),
           added_cycle(tran.added_cycle),
           complete_cycle(tran.complete_cycle),
+          seq(tran.seq),
           is_write(tran.is_write) {}
     uint64_t addr;
     uint64_t added_cycle;
     uint64_t complete_cycle;
+    // unique per controller, set when it is queued
+    uint64_t seq;
     bool is_write;
 
     friend std::ostream& operator<<(std::ostream& os, const Transaction& trans);
@@ -140,7 +143,6 @@ struct HMTTTransaction {
     friend std::ostream& operator<<(std::ostream& os, const HMTTTransaction& trans);
 };
 
-void GetNextHMTT(HMTTTransaction &trans, int ppid, uint64_t num_p);
 
 }  // namespace dramsim3
 #endif
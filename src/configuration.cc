@@ -173,6 +173,13 @@ void Config::InitOtherParams() {
     // 1: default value, adds epoch CSV output on level 0
     // 2: adds histogram outputs in a different CSV format
     output_level = reader.GetInteger("other", "output_level", 1);
+    tick_threads = GetInteger("other", "tick_threads", 1);
+    epoch_format = reader.Get("other", "epoch_format", "json");
+    if (epoch_format != "json" && epoch_format != "jsonl" &&
+        epoch_format != "binary") {
+        std::cerr << "Unknown epoch_format " << epoch_format << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
     // Other Parameters
     // give a prefix instead of specify the output name one by one...
     // this would allow outputing to a directory and you can always override
@@ -188,7 +195,11 @@ void Config::InitOtherParams() {
     output_prefix =
         output_dir + reader.Get("other", "output_prefix", "dramsim3");
     json_stats_name = output_prefix + ".json";
-    json_epoch_name = output_prefix + "epoch.json";
+    if (epoch_format == "binary") {
+        json_epoch_name = output_prefix + "epoch.bin";
+    } else {
+        json_epoch_name = output_prefix + "epoch." + epoch_format;
+    }
     txt_stats_name = output_prefix + ".txt";
     return;
 }
@@ -239,6 +250,19 @@ void Config::InitSystemParams() {
     trans_queue_size = GetInteger("system", "trans_queue_size", 32);
     unified_queue = reader.GetBoolean("system", "unified_queue", false);
     write_buf_size = GetInteger("system", "write_buf_size", 16);
+    trans_scheduler = reader.Get("system", "scheduler", "FCFS");
+    row_hit_cap = GetInteger("system", "row_hit_cap", 4);
+    bliss_threshold = GetInteger("system", "bliss_threshold", 4);
+    bliss_clear_interval = GetInteger("system", "bliss_clear_interval", 10000);
+    batch_cap = GetInteger("system", "batch_cap", 5);
+    if (trans_scheduler == "BLISS" && !unified_queue) {
+        // reads and writes are the only sources BLISS tells apart, split
+        // queues never show it both
+        std::cerr << "scheduler = BLISS needs unified_queue = True"
+                  << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    write_drain_threshold = GetInteger("system", "write_drain_threshold", 8);
     std::string ref_policy =
         reader.Get("system", "refresh_policy", "RANK_LEVEL_STAGGERED");
     if (ref_policy == "RANK_LEVEL_SIMULTANEOUS") {
@@ -250,6 +274,14 @@ void Config::InitSystemParams() {
     } else {
         AbruptExit(__FILE__, __LINE__);
     }
+    refresh_postpone = GetInteger("system", "refresh_postpone", 0);
+    refresh_pullin = GetInteger("system", "refresh_pullin", 0);
+    if (refresh_postpone < 0 || refresh_postpone > 8 || refresh_pullin < 0 ||
+        refresh_pullin > 8) {
+        std::cerr << "refresh_postpone and refresh_pullin must be 0 to 8"
+                  << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
 
     enable_self_refresh =
         reader.GetBoolean("system", "enable_self_refresh", false);
@@ -143,10 +143,22 @@ class Config {
     std::string queue_structure;
     std::string row_buf_policy;
     RefreshPolicy refresh_policy;
+    // due refreshes a busy rank may hold back and idle refreshes it may
+    // issue ahead of time, at most 8 each as in JEDEC DDR4
+    int refresh_postpone;
+    int refresh_pullin;
     int cmd_queue_size;
     bool unified_queue;
     int trans_queue_size;
     int write_buf_size;
+    // transaction scheduling, see scheduler.h
+    std::string trans_scheduler;
+    int row_hit_cap;
+    int bliss_threshold;
+    int bliss_clear_interval;
+    int batch_cap;
+    // writes buffered before draining them while the command queue is idle
+    int write_drain_threshold;
     bool enable_self_refresh;
     int sref_threshold;
     bool aggressive_precharging_enabled;
@@ -155,6 +167,11 @@ class Config {
 
     int epoch_period;
     int output_level;
+    // threads ticking the channels of a system, 1 ticks them in order
+    int tick_threads;
+    // epoch stats file: "json" (an array), "jsonl" (a record per line) or
+    // "binary" (see SimpleStats::PrintEpochStats)
+    std::string epoch_format;
     std::string output_dir;
     std::string output_prefix;
     std::string json_stats_name;
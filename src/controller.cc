@@ -1,4 +1,5 @@
 #include "controller.h"
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
 #include <limits>
@@ -15,18 +16,54 @@ Controller::Controller(int channel, const Config &config, const Timing &timing)
       clk_(0),
       config_(config),
       simple_stats_(config_, channel_id_),
+      reads_done_stat_(simple_stats_.CounterId("num_reads_done")),
+      writes_done_stat_(simple_stats_.CounterId("num_writes_done")),
+      read_latency_stat_(simple_stats_.HistoId("read_latency")),
+      write_latency_stat_(simple_stats_.HistoId("write_latency")),
+      interarrival_stat_(simple_stats_.HistoId("interarrival_latency")),
+      num_cycles_stat_(simple_stats_.CounterId("num_cycles")),
+      hbm_dual_stat_(simple_stats_.CounterId("hbm_dual_cmds")),
+      sref_cycles_stat_(simple_stats_.VecCounterId("sref_cycles")),
+      idle_cycles_stat_(simple_stats_.VecCounterId("all_bank_idle_cycles")),
+      active_cycles_stat_(simple_stats_.VecCounterId("rank_active_cycles")),
+      rank_power_stat_(config.ranks, idle_cycles_stat_),
+      rank_power_since_(config.ranks, 0),
+      rank_idle_base_(config.ranks, 0),
+      read_row_hits_stat_(simple_stats_.CounterId("num_read_row_hits")),
+      write_row_hits_stat_(simple_stats_.CounterId("num_write_row_hits")),
+      cmd_stats_(static_cast<int>(CommandType::SIZE), -1),
       channel_state_(config, timing),
       cmd_queue_(channel_id_, config, channel_state_, simple_stats_),
-      refresh_(config, channel_state_),
+      refresh_(config, channel_state_, cmd_queue_),
 #ifdef THERMAL
       thermal_calc_(thermal_calc),
 #endif  // THERMAL
       is_unified_queue_(config.unified_queue),
+      pending_rd_q_(config.trans_queue_size),
+      pending_wr_q_(config.trans_queue_size),
+      return_seq_(0),
       row_buf_policy_(config.row_buf_policy == "CLOSE_PAGE"
                           ? RowBufPolicy::CLOSE_PAGE
                           : RowBufPolicy::OPEN_PAGE),
       last_trans_clk_(0),
-      write_draining_(0) {
+      trans_seq_(0),
+      write_draining_(0),
+      scheduler_(MakeTransactionScheduler(config_, channel_state_)) {
+    const std::vector<std::pair<CommandType, std::string>> cmd_stats = {
+        {CommandType::READ, "num_read_cmds"},
+        {CommandType::READ_PRECHARGE, "num_read_cmds"},
+        {CommandType::WRITE, "num_write_cmds"},
+        {CommandType::WRITE_PRECHARGE, "num_write_cmds"},
+        {CommandType::ACTIVATE, "num_act_cmds"},
+        {CommandType::PRECHARGE, "num_pre_cmds"},
+        {CommandType::REFRESH, "num_ref_cmds"},
+        {CommandType::REFRESH_BANK, "num_refb_cmds"},
+        {CommandType::SREF_ENTER, "num_srefe_cmds"},
+        {CommandType::SREF_EXIT, "num_srefx_cmds"}};
+    for (const auto &it : cmd_stats) {
+        cmd_stats_[static_cast<int>(it.first)] =
+            simple_stats_.CounterId(it.second);
+    }
     if (is_unified_queue_) {
         unified_queue_.reserve(config_.trans_queue_size);
     } else {
@@ -42,24 +79,27 @@ Controller::Controller(int channel, const Config &config, const Timing &timing)
 #endif  // CMD_TRACE
 }
 
+Controller::~Controller() { delete scheduler_; }
+
 std::pair<uint64_t, int> Controller::ReturnDoneTrans(uint64_t clk) {
-    auto it = return_queue_.begin();
-    while (it != return_queue_.end()) {
-        if (clk >= it->complete_cycle) {
-            if (it->is_write) {
-                simple_stats_.Increment("num_writes_done");
-            } else {
-                simple_stats_.Increment("num_reads_done");
-                simple_stats_.AddValue("read_latency", clk_ - it->added_cycle);
-            }
-            auto pair = std::make_pair(it->addr, it->is_write);
-            it = return_queue_.erase(it);
-            return pair;
-        } else {
-            ++it;
-        }
+    if (return_queue_.empty() ||
+        clk < return_queue_.top().trans.complete_cycle) {
+        return std::make_pair(-1, -1);
+    }
+    const Transaction &trans = return_queue_.top().trans;
+    if (trans.is_write) {
+        simple_stats_.Increment(writes_done_stat_);
+    } else {
+        simple_stats_.Increment(reads_done_stat_);
+        simple_stats_.AddValue(read_latency_stat_, clk_ - trans.added_cycle);
     }
-    return std::make_pair(-1, -1);
+    auto pair = std::make_pair(trans.addr, trans.is_write);
+    return_queue_.pop();
+    return pair;
+}
+
+void Controller::PushDone(const Transaction &trans) {
+    return_queue_.push(DoneTrans{return_seq_++, trans});
 }
 
 void Controller::ClockTick() {
@@ -79,6 +119,7 @@ void Controller::ClockTick() {
 
     if (cmd.IsValid()) {
         IssueCommand(cmd);
+        UpdateRankPower(cmd.Rank(), clk_);
         cmd_issued = true;
 
         if (config_.enable_hbm_dual_cmd) {
@@ -86,30 +127,15 @@ void Controller::ClockTick() {
             if (second_cmd.IsValid()) {
                 if (second_cmd.IsReadWrite() != cmd.IsReadWrite()) {
                     IssueCommand(second_cmd);
-                    simple_stats_.Increment("hbm_dual_cmds");
+                    UpdateRankPower(second_cmd.Rank(), clk_);
+                    simple_stats_.Increment(hbm_dual_stat_);
                 }
             }
         }
     }
 
-    // power updates pt 1
-    for (int i = 0; i < config_.ranks; i++) {
-        if (channel_state_.IsRankSelfRefreshing(i)) {
-            simple_stats_.IncrementVec("sref_cycles", i);
-        } else {
-            bool all_idle = channel_state_.IsAllBankIdleInRank(i);
-            if (all_idle) {
-                simple_stats_.IncrementVec("all_bank_idle_cycles", i);
-                channel_state_.rank_idle_cycles[i] += 1;
-            } else {
-                simple_stats_.IncrementVec("rank_active_cycles", i);
-                // reset
-                channel_state_.rank_idle_cycles[i] = 0;
-            }
-        }
-    }
-
-    // power updates pt 2: move idle ranks into self-refresh mode to save power
+    // power updates: move idle ranks into self-refresh mode to save power,
+    // this cycle still counts in the state before
     if (config_.enable_self_refresh && !cmd_issued) {
         for (auto i = 0; i < config_.ranks; i++) {
             if (channel_state_.IsRankSelfRefreshing(i)) {
@@ -121,19 +147,23 @@ void Controller::ClockTick() {
                     cmd = channel_state_.GetReadyCommand(cmd, clk_);
                     if (cmd.IsValid()) {
                         IssueCommand(cmd);
+                        UpdateRankPower(i, clk_ + 1);
                         break;
                     }
                 }
             } else {
+                // a waiting refresh cannot issue to a self-refreshing rank
                 if (cmd_queue_.rank_q_empty[i] &&
-                    channel_state_.rank_idle_cycles[i] >=
-                        config_.sref_threshold) {
+                    !channel_state_.IsRefreshPending(i) &&
+                    RankIdleCycles(i, clk_ + 1) >=
+                        static_cast<uint64_t>(config_.sref_threshold)) {
                     auto addr = Address();
                     addr.rank = i;
                     auto cmd = Command(CommandType::SREF_ENTER, addr, -1);
                     cmd = channel_state_.GetReadyCommand(cmd, clk_);
                     if (cmd.IsValid()) {
                         IssueCommand(cmd);
+                        UpdateRankPower(i, clk_ + 1);
                         break;
                     }
                 }
@@ -144,10 +174,61 @@ void Controller::ClockTick() {
     ScheduleTransaction();
     clk_++;
     cmd_queue_.ClockTick();
-    simple_stats_.Increment("num_cycles");
+    simple_stats_.Increment(num_cycles_stat_);
     return;
 }
 
+uint64_t Controller::NextEventCycle() const {
+    uint64_t next = refresh_.NextRefreshCycle();
+    if (next == clk_ || channel_state_.IsRefreshWaiting() ||
+        !unified_queue_.empty() || !read_queue_.empty()) {
+        return clk_;
+    }
+    // queued commands wait for their banks' timing
+    next = std::min(next, cmd_queue_.NextReadyCycle());
+    if (next == clk_) {
+        return clk_;
+    }
+    // a few writes wait in the buffer until ScheduleTransaction() drains it
+    if (!write_buffer_.empty() &&
+        (write_draining_ > 0 ||
+         write_buffer_.size() >
+             static_cast<size_t>(config_.write_drain_threshold) ||
+         write_buffer_.size() >= write_buffer_.capacity())) {
+        return clk_;
+    }
+    if (!return_queue_.empty()) {
+        next = std::min(next,
+                        std::max(return_queue_.top().trans.complete_cycle, clk_));
+    }
+    if (config_.enable_self_refresh) {
+        for (int i = 0; i < config_.ranks; i++) {
+            if (channel_state_.IsRankSelfRefreshing(i)) {
+                if (!cmd_queue_.rank_q_empty[i]) return clk_;
+            } else if (cmd_queue_.rank_q_empty[i] &&
+                       channel_state_.IsAllBankIdleInRank(i)) {
+                // self-refresh entry once idle long enough
+                uint64_t idle = RankIdleCycles(i, clk_);
+                uint64_t threshold = config_.sref_threshold;
+                next = std::min(next, clk_ + (idle < threshold
+                                                  ? threshold - idle
+                                                  : 0));
+            }
+        }
+    }
+    return next;
+}
+
+void Controller::FastForward(uint64_t clk) {
+    if (clk <= clk_) return;
+    uint64_t cycles = clk - clk_;
+    refresh_.FastForward(cycles);
+    // no rank changes power state meanwhile
+    clk_ = clk;
+    cmd_queue_.FastForward(cycles);
+    simple_stats_.IncrementBy(num_cycles_stat_, cycles);
+}
+
 bool Controller::WillAcceptTransaction(uint64_t hex_addr, bool is_write) const {
     if (is_unified_queue_) {
         return unified_queue_.size() < unified_queue_.capacity();
@@ -160,12 +241,13 @@ bool Controller::WillAcceptTransaction(uint64_t hex_addr, bool is_write) const {
 
 bool Controller::AddTransaction(Transaction trans) {
     trans.added_cycle = clk_;
-    simple_stats_.AddValue("interarrival_latency", clk_ - last_trans_clk_);
+    trans.seq = trans_seq_++;
+    simple_stats_.AddValue(interarrival_stat_, clk_ - last_trans_clk_);
     last_trans_clk_ = clk_;
 
     if (trans.is_write) {
-        if (pending_wr_q_.count(trans.addr) == 0) {  // can not merge writes
-            pending_wr_q_.insert(std::make_pair(trans.addr, trans));
+        if (pending_wr_q_.Count(trans.addr) == 0) {  // can not merge writes
+            pending_wr_q_.Push(trans);
             if (is_unified_queue_) {
                 unified_queue_.push_back(trans);
             } else {
@@ -173,17 +255,17 @@ bool Controller::AddTransaction(Transaction trans) {
             }
         }
         trans.complete_cycle = clk_ + 1;
-        return_queue_.push_back(trans);
+        PushDone(trans);
         return true;
     } else {  // read
         // if in write buffer, use the write buffer value
-        if (pending_wr_q_.count(trans.addr) > 0) {
+        if (pending_wr_q_.Count(trans.addr) > 0) {
             trans.complete_cycle = clk_ + 1;
-            return_queue_.push_back(trans);
+            PushDone(trans);
             return true;
         }
-        pending_rd_q_.insert(std::make_pair(trans.addr, trans));
-        if (pending_rd_q_.count(trans.addr) == 1) {
+        pending_rd_q_.Push(trans);
+        if (pending_rd_q_.Count(trans.addr) == 1) {
             if (is_unified_queue_) {
                 unified_queue_.push_back(trans);
             } else {
@@ -199,7 +281,9 @@ void Controller::ScheduleTransaction() {
     if (write_draining_ == 0 && !is_unified_queue_) {
         // we basically have a upper and lower threshold for write buffer
         if ((write_buffer_.size() >= write_buffer_.capacity()) ||
-            (write_buffer_.size() > 8 && cmd_queue_.QueueEmpty())) {
+            (write_buffer_.size() >
+                 static_cast<size_t>(config_.write_drain_threshold) &&
+             cmd_queue_.QueueEmpty())) {
             write_draining_ = write_buffer_.size();
         }
     }
@@ -207,27 +291,38 @@ void Controller::ScheduleTransaction() {
     std::vector<Transaction> &queue =
         is_unified_queue_ ? unified_queue_
                           : write_draining_ > 0 ? write_buffer_ : read_queue_;
-    for (auto it = queue.begin(); it != queue.end(); it++) {
-        auto cmd = TransToCommand(*it);
+    candidates_.clear();
+    for (size_t i = 0; i < queue.size(); i++) {
+        auto cmd = TransToCommand(queue[i]);
         if (cmd_queue_.WillAcceptCommand(cmd.Rank(), cmd.Bankgroup(),
                                          cmd.Bank())) {
-            if (!is_unified_queue_ && cmd.IsWrite()) {
-                // Enforce R->W dependency
-                if (pending_rd_q_.count(it->addr) > 0) {
-                    write_draining_ = 0;
-                    if(write_buffer_.size() >= write_buffer_.capacity()) {
-                        std::cerr<<"stuck here "<<it->addr<<"\n";
-                        AbruptExit(__FILE__, __LINE__);
-                    }
-                    break;
-                }
-                write_draining_ -= 1;
+            candidates_.push_back(SchedCandidate{i, cmd});
+            if (!scheduler_->NeedsAllCandidates()) {
+                break;
+            }
+        }
+    }
+    if (candidates_.empty()) {
+        return;
+    }
+    const SchedCandidate &pick =
+        candidates_[scheduler_->Pick(queue, candidates_, clk_)];
+    auto it = queue.begin() + pick.index;
+    if (!is_unified_queue_ && pick.cmd.IsWrite()) {
+        // Enforce R->W dependency
+        if (pending_rd_q_.Count(it->addr) > 0) {
+            write_draining_ = 0;
+            if(write_buffer_.size() >= write_buffer_.capacity()) {
+                std::cerr<<"stuck here "<<it->addr<<"\n";
+                AbruptExit(__FILE__, __LINE__);
             }
-            cmd_queue_.AddCommand(cmd);
-            queue.erase(it);
-            break;
+            return;
         }
+        write_draining_ -= 1;
     }
+    cmd_queue_.AddCommand(pick.cmd);
+    scheduler_->Scheduled(*it, pick.cmd, clk_);
+    queue.erase(it);
 }
 
 void Controller::IssueCommand(const Command &cmd) {
@@ -240,29 +335,25 @@ void Controller::IssueCommand(const Command &cmd) {
 #endif  // THERMAL
     // if read/write, update pending queue and return queue
     if (cmd.IsRead()) {
-        auto num_reads = pending_rd_q_.count(cmd.hex_addr);
-        if (num_reads == 0) {
+        if (pending_rd_q_.Count(cmd.hex_addr) == 0) {
             std::cerr << cmd.hex_addr << " not in read queue! " << std::endl;
             exit(1);
         }
         // if there are multiple reads pending return them all
-        while (num_reads > 0) {
-            auto it = pending_rd_q_.find(cmd.hex_addr);
-            it->second.complete_cycle = clk_ + config_.read_delay;
-            return_queue_.push_back(it->second);
-            pending_rd_q_.erase(it);
-            num_reads -= 1;
+        Transaction trans;
+        while (pending_rd_q_.Pop(cmd.hex_addr, trans)) {
+            trans.complete_cycle = clk_ + config_.read_delay;
+            PushDone(trans);
         }
     } else if (cmd.IsWrite()) {
         // there should be only 1 write to the same location at a time
-        auto it = pending_wr_q_.find(cmd.hex_addr);
-        if (it == pending_wr_q_.end()) {
+        Transaction trans;
+        if (!pending_wr_q_.Pop(cmd.hex_addr, trans)) {
             std::cerr << cmd.hex_addr << " not in write queue!" << std::endl;
             exit(1);
         }
-        auto wr_lat = clk_ - it->second.added_cycle + config_.write_delay;
-        simple_stats_.AddValue("write_latency", wr_lat);
-        pending_wr_q_.erase(it);
+        auto wr_lat = clk_ - trans.added_cycle + config_.write_delay;
+        simple_stats_.AddValue(write_latency_stat_, wr_lat);
     }
     // must update stats before states (for row hits)
     UpdateCommandStats(cmd);
@@ -283,9 +374,10 @@ Command Controller::TransToCommand(const Transaction &trans) {
 
 int Controller::QueueUsage() const { return cmd_queue_.QueueUsage(); }
 
-void Controller::PrintEpochStats() {
+void Controller::PrintEpochStats(StatsSink *sink) {
+    UpdatePowerStats();
     simple_stats_.Increment("epoch_num");
-    simple_stats_.PrintEpochStats();
+    simple_stats_.PrintEpochStats(sink);
 #ifdef THERMAL
     for (int r = 0; r < config_.ranks; r++) {
         double bg_energy = simple_stats_.RankBackgroundEnergy(r);
@@ -296,6 +388,7 @@ void Controller::PrintEpochStats() {
 }
 
 void Controller::PrintFinalStats() {
+    UpdatePowerStats();
     simple_stats_.PrintFinalStats();
 
 #ifdef THERMAL
@@ -307,45 +400,69 @@ void Controller::PrintFinalStats() {
     return;
 }
 
+void Controller::ResetStats() {
+    // cycles before the reset are dropped
+    UpdatePowerStats();
+    simple_stats_.Reset();
+}
+
 void Controller::UpdateCommandStats(const Command &cmd) {
-    switch (cmd.cmd_type) {
-        case CommandType::READ:
-        case CommandType::READ_PRECHARGE:
-            simple_stats_.Increment("num_read_cmds");
-            if (channel_state_.RowHitCount(cmd.Rank(), cmd.Bankgroup(),
-                                           cmd.Bank()) != 0) {
-                simple_stats_.Increment("num_read_row_hits");
-            }
-            break;
-        case CommandType::WRITE:
-        case CommandType::WRITE_PRECHARGE:
-            simple_stats_.Increment("num_write_cmds");
-            if (channel_state_.RowHitCount(cmd.Rank(), cmd.Bankgroup(),
-                                           cmd.Bank()) != 0) {
-                simple_stats_.Increment("num_write_row_hits");
-            }
-            break;
-        case CommandType::ACTIVATE:
-            simple_stats_.Increment("num_act_cmds");
-            break;
-        case CommandType::PRECHARGE:
-            simple_stats_.Increment("num_pre_cmds");
-            break;
-        case CommandType::REFRESH:
-            simple_stats_.Increment("num_ref_cmds");
-            break;
-        case CommandType::REFRESH_BANK:
-            simple_stats_.Increment("num_refb_cmds");
-            break;
-        case CommandType::SREF_ENTER:
-            simple_stats_.Increment("num_srefe_cmds");
-            break;
-        case CommandType::SREF_EXIT:
-            simple_stats_.Increment("num_srefx_cmds");
-            break;
-        default:
-            AbruptExit(__FILE__, __LINE__);
+    int stat = cmd_stats_[static_cast<int>(cmd.cmd_type)];
+    if (stat < 0) {
+        AbruptExit(__FILE__, __LINE__);
+    }
+    simple_stats_.Increment(stat);
+    if (cmd.IsReadWrite() &&
+        channel_state_.RowHitCount(cmd.Rank(), cmd.Bankgroup(), cmd.Bank()) !=
+            0) {
+        simple_stats_.Increment(cmd.IsRead() ? read_row_hits_stat_
+                                             : write_row_hits_stat_);
+    }
+}
+
+int Controller::RankPowerStat(int rank) const {
+    if (channel_state_.IsRankSelfRefreshing(rank)) {
+        return sref_cycles_stat_;
+    } else if (channel_state_.IsAllBankIdleInRank(rank)) {
+        return idle_cycles_stat_;
+    }
+    return active_cycles_stat_;
+}
+
+void Controller::UpdateRankPower(int rank, uint64_t clk) {
+    int stat = RankPowerStat(rank);
+    int prev = rank_power_stat_[rank];
+    if (stat == prev) {
+        return;
+    }
+    uint64_t cycles = clk - rank_power_since_[rank];
+    simple_stats_.IncrementVecBy(prev, rank, cycles);
+    if (stat == active_cycles_stat_) {
+        rank_idle_base_[rank] = 0;
+    } else if (prev == idle_cycles_stat_) {
+        rank_idle_base_[rank] += cycles;
+    }
+    rank_power_stat_[rank] = stat;
+    rank_power_since_[rank] = clk;
+}
+
+void Controller::UpdatePowerStats() {
+    for (int i = 0; i < config_.ranks; i++) {
+        uint64_t cycles = clk_ - rank_power_since_[i];
+        simple_stats_.IncrementVecBy(rank_power_stat_[i], i, cycles);
+        if (rank_power_stat_[i] == idle_cycles_stat_) {
+            rank_idle_base_[i] += cycles;
+        }
+        rank_power_since_[i] = clk_;
+    }
+}
+
+uint64_t Controller::RankIdleCycles(int rank, uint64_t clk) const {
+    uint64_t cycles = rank_idle_base_[rank];
+    if (rank_power_stat_[rank] == idle_cycles_stat_) {
+        cycles += clk - rank_power_since_[rank];
     }
+    return cycles;
 }
 
 }  // namespace dramsim3
@@ -2,13 +2,15 @@
 #define __CONTROLLER_H
 
 #include <fstream>
-#include <map>
+#include <queue>
 #include <unordered_set>
 #include <vector>
 #include "channel_state.h"
 #include "command_queue.h"
 #include "common.h"
+#include "pending_table.h"
 #include "refresh.h"
+#include "scheduler.h"
 #include "simple_stats.h"
 
 #ifdef THERMAL
@@ -27,14 +29,20 @@ class Controller {
 #else
     Controller(int channel, const Config &config, const Timing &timing);
 #endif  // THERMAL
+    ~Controller();
     void ClockTick();
+    // first clock whose ClockTick() (or ReturnDoneTrans) does more than
+    // advancing clocks and idle counters, the current clock if busy
+    uint64_t NextEventCycle() const;
+    // advance to `clk` (<= NextEventCycle()) as ClockTick() would
+    void FastForward(uint64_t clk);
     bool WillAcceptTransaction(uint64_t hex_addr, bool is_write) const;
     bool AddTransaction(Transaction trans);
     int QueueUsage() const;
     // Stats output
-    void PrintEpochStats();
+    void PrintEpochStats(StatsSink *sink);
     void PrintFinalStats();
-    void ResetStats() { simple_stats_.Reset(); }
+    void ResetStats();
     std::pair<uint64_t, int> ReturnDoneTrans(uint64_t clock);
 
     int channel_id_;
@@ -43,6 +51,28 @@ class Controller {
     uint64_t clk_;
     const Config &config_;
     SimpleStats simple_stats_;
+    // handles of the stats updated every cycle or command
+    int reads_done_stat_;
+    int writes_done_stat_;
+    int read_latency_stat_;
+    int write_latency_stat_;
+    int interarrival_stat_;
+    int num_cycles_stat_;
+    int hbm_dual_stat_;
+    int sref_cycles_stat_;
+    int idle_cycles_stat_;
+    int active_cycles_stat_;
+    // power state accounting: the counter a rank's cycles go to and the
+    // clock it entered that state, the cycles are added when the rank
+    // changes state or the stats are read
+    std::vector<int> rank_power_stat_;
+    std::vector<uint64_t> rank_power_since_;
+    // idle cycles of a rank before its current state, self-refresh does
+    // not end an idle period
+    std::vector<uint64_t> rank_idle_base_;
+    int read_row_hits_stat_;
+    int write_row_hits_stat_;
+    std::vector<int> cmd_stats_;  // counter of each CommandType
     ChannelState channel_state_;
     CommandQueue cmd_queue_;
     Refresh refresh_;
@@ -57,12 +87,26 @@ class Controller {
     std::vector<Transaction> read_queue_;
     std::vector<Transaction> write_buffer_;
 
-    // transactions that are not completed, use map for convenience
-    std::multimap<uint64_t, Transaction> pending_rd_q_;
-    std::multimap<uint64_t, Transaction> pending_wr_q_;
+    // transactions that are not completed, by address
+    PendingTable pending_rd_q_;
+    PendingTable pending_wr_q_;
 
-    // completed transactions
-    std::vector<Transaction> return_queue_;
+    // completed transactions, returned by complete_cycle and then in the
+    // order they completed
+    struct DoneTrans {
+        uint64_t seq;
+        Transaction trans;
+        bool operator>(const DoneTrans &d) const {
+            return trans.complete_cycle != d.trans.complete_cycle
+                       ? trans.complete_cycle > d.trans.complete_cycle
+                       : seq > d.seq;
+        }
+    };
+    std::priority_queue<DoneTrans, std::vector<DoneTrans>,
+                        std::greater<DoneTrans>>
+        return_queue_;
+    uint64_t return_seq_;
+    void PushDone(const Transaction &trans);
 
     // row buffer policy
     RowBufPolicy row_buf_policy_;
@@ -73,13 +117,24 @@ class Controller {
 
     // used to calculate inter-arrival latency
     uint64_t last_trans_clk_;
+    // next Transaction::seq
+    uint64_t trans_seq_;
 
     // transaction queueing
     int write_draining_;
+    TransactionScheduler *scheduler_;
+    std::vector<SchedCandidate> candidates_;
     void ScheduleTransaction();
     void IssueCommand(const Command &tmp_cmd);
     Command TransToCommand(const Transaction &trans);
     void UpdateCommandStats(const Command &cmd);
+    int RankPowerStat(int rank) const;
+    // the rank's state may have changed, effective from `clk`
+    void UpdateRankPower(int rank, uint64_t clk);
+    // add the cycles up to clk_ to the power state counters
+    void UpdatePowerStats();
+    // consecutive cycles the rank was idle before `clk`
+    uint64_t RankIdleCycles(int rank, uint64_t clk) const;
 };
 }  // namespace dramsim3
 #endif
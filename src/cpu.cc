@@ -1,7 +1,14 @@
 #include "cpu.h"
+#include <iomanip>
+#include <sstream>
 
 namespace dramsim3 {
 
+static bool HasSuffix(const std::string &s, const std::string &suffix) {
+    return s.size() > suffix.size() &&
+           s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
 void RandomCPU::ClockTick() {
     // Create random CPU requests at full speed
     // this is useful to exploit the parallelism of a DRAM protocol
@@ -103,193 +110,360 @@ void TraceBasedCPU::ClockTick() {
 }
 
 HMTTCPU::HMTTCPU(const std::string &config_file, const std::string &output_dir, const std::string &trace_file,
-                 const std::string &seg_file, int ppid_, uint64_t num_p_)
+                 int ppid_, uint64_t num_p_, bool use_mmap)
     : CPU(config_file, output_dir,
                     std::bind(&HMTTCPU::ReadCallBack, this, std::placeholders::_1)),
     memory_system_local("configs/DDR4_4Gb_x4_1866.ini", output_dir + "/local",
                         std::bind(&HMTTCPU::ReadCallBack, this, std::placeholders::_1),
                         std::bind(&CPU::WriteCallBack, this, std::placeholders::_1)),
     rob_sz(256 / memory_system_.GetTCK()),
-    cur_seg(0,0,0), ppid(ppid_), num_p(num_p_){
+    cur_seg(0,0,0), ppid(ppid_), num_p(num_p_),
+    sampled_stats_({"cpu clock", "wall clock", "average read latency (ns)",
+                    "System performance downgradation (%)"}),
+    prefetcher_(std::bind(&HMTTCPU::ReadTrans, this, std::placeholders::_1)),
+    use_prefetch_(std::thread::hardware_concurrency() > 1){
 
-    last_req_ns = 0;
-    wait = rob.end();
-    outstanding = 0;
     wall_clk = 0;
-    for (int i = 0; i < mshr_sz; ++i) {
-        read_outstanding[i] = 0;
+    cores_.assign(1, HMTTCore(rob_sz + mshr_sz));
+    last_core_ = 0;
+    issue_rr_ = 0;
+    trace_ns_ = 0;
+    trace_end_ = false;
+
+    trace_id = 0;
+    segment_count = 0;
+    seg_length = simulating;
+    use_simpoint_ = false;
+    warmup_distance = UINT64_MAX;
+    fast_forward_ = true;
+    config_file_ = config_file;
+    trace_file_ = trace_file;
+    benchmark_ = output_dir.substr(output_dir.find_last_of('/') + 1);
+
+    use_cache_ = HasSuffix(trace_file, ".htc");
+    if(use_cache_){
+        if(!trace_cache_.Open(trace_file)){
+            AbruptExit(__FILE__, __LINE__);
+        }
+    }else{
+        trace_reader_.Init((trace_file+".trace").c_str(), (trace_file+".kt").c_str(), use_mmap);
     }
-    kernel_trace_count = 0;
-    app_trace_count = 0;
-    read_latency.clear();
+}
 
+HMTTCPU::HMTTCPU(const std::string &config_file, const std::string &output_dir, const std::string &trace_file,
+                 const std::string &seg_file, int ppid_, uint64_t num_p_, bool use_mmap)
+    : HMTTCPU(config_file, output_dir, trace_file, ppid_, num_p_, use_mmap){
     seg_file_.open(seg_file);
     if (seg_file_.fail()) {
         std::cerr << "Trace file does not exist" << std::endl;
         AbruptExit(__FILE__, __LINE__);
     }
-    trace_id = 0;
-    segment_count = 0;
+    use_simpoint_ = HasSuffix(seg_file, ".simpt");
+    if(!use_simpoint_){
+        //the first segment, dramsim3main runs the others on their own
+        //instances
+        std::vector<WorkingSet> segs = ReadSegments(seg_file);
+        if(!segs.empty()){
+            cur_seg = segs[0];
+            segment_count = 1;
+            return;
+        }
+    }
     if(!GetNextSeg()){
         std::cerr << "Segment does not exist" << std::endl;
         AbruptExit(__FILE__, __LINE__);
     }
+}
 
-    trace_init((trace_file+".trace").c_str(), (trace_file+".kt").c_str());
-    tmp.valid = true;
+HMTTCPU::HMTTCPU(const std::string &config_file, const std::string &output_dir, const std::string &trace_file,
+                 const WorkingSet &seg, int ppid_, uint64_t num_p_, bool use_mmap)
+    : HMTTCPU(config_file, output_dir, trace_file, ppid_, num_p_, use_mmap){
+    cur_seg = seg;
+    segment_count = 1;
 }
 
-void HMTTCPU::ClockTick() {
-    memory_system_.ClockTick();
-    memory_system_local.ClockTick();
-    if(get_next_){
-        if(tmp.valid){
-            GetNextHMTT(tmp, ppid, num_p);
-            trace_id++;
-            get_next_ = false;
-            //std::cout<<"["<<std::dec<<kernel_trace_count + app_trace_count<<"]: "<<tmp.added_ns
-            //<<" "<<std::hex<<tmp.addr<<(tmp.is_kernel ? " kernel" : " app")
-            //<<(tmp.r_w ? " Read": " Write")<<"\n"<<std::dec;
+std::vector<WorkingSet> HMTTCPU::ReadSegments(const std::string &seg_file) {
+    std::ifstream file(seg_file);
+    if (file.fail()) {
+        std::cerr << "Segment file does not exist" << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    std::vector<WorkingSet> segs;
+    std::string line;
+    int line_no = 0;
+    while(std::getline(file, line)){
+        line_no++;
+        size_t first = line.find_first_not_of(" \t\r");
+        if(first == std::string::npos || line[first] == '#')
+            continue;
+        std::istringstream fields(line);
+        std::vector<uint64_t> f;
+        uint64_t v;
+        while(fields>>v)
+            f.push_back(v);
+        WorkingSet seg(0, 0, 0);
+        if(!fields.eof()){
+            f.clear();
+        }else if(f.size() == 1){
+            //entry count heading a .ws file
+            continue;
+        }else if(f.size() == 4){
+            //.ws: sid eid #pages ns
+            seg = WorkingSet(f[0], f[1], f[2]);
+            seg.time = f[3];
+        }else if(f.size() == 10){
+            //.seg: ppid #proc sid eid length ns #pages #read #write #kernel,
+            //eid is the last id of the segment
+            seg = WorkingSet(f[2], f[3] + 1, f[6]);
+            seg.time = f[5];
         }
+        if(seg.sid >= seg.eid){
+            std::cerr << seg_file << ":" << line_no
+                      << ": not a .seg or .ws segment line" << std::endl;
+            AbruptExit(__FILE__, __LINE__);
+        }
+        segs.push_back(seg);
     }
+    return segs;
+}
 
-    if(tmp.valid){
-        if(rob.empty()){
+void HMTTCore::Reset() {
+    tmp.valid = true;
+    get_next = true;
+    last_req_ns = 0;
+    rob.Clear();
+    outstanding = 0;
+    clk = 0;
+    stall_clk = 0;
+    pending.clear();
+    last_trace_ns = 0;
+    kernel_trace_count = 0;
+    app_trace_count = 0;
+    read_outstanding.clear();
+    read_latency.Clear();
+}
 
-            wall_clk += ceil(tmp.added_ns / memory_system_.GetTCK());
-            last_req_ns += tmp.added_ns;
-            tmp.added_ns = 0;
-            clk_ = ceil(last_req_ns / memory_system_.GetTCK());
-            //std::cout<<"fast forwarding to next trace "<<clk_<<" "<<wall_clk<<"\n";
-        }
+void HMTTCPU::SetMultiCore(bool enable) {
+    cores_.assign(enable ? std::max<uint64_t>(num_p, 1) : 1, HMTTCore(rob_sz + mshr_sz));
+    last_core_ = 0;
+    issue_rr_ = 0;
+}
 
-        if((tmp.added_ns + last_req_ns) <= (clk_ * memory_system_.GetTCK())){
-            last_req_ns += tmp.added_ns;
-            tmp.added_ns = clk_;
-            tmp.is_finished = false;
-            //tmp.addr = (tmp.addr >> 12) << 12;
-            rob.emplace_back(tmp);
-            get_next_ = true;
-            if(wait == rob.end()){
-                wait--;
-            }
+size_t HMTTCPU::CoreOf(const HMTTTransaction &trans) {
+    if(!IsMultiCore())
+        return 0;
+    if(!trans.is_kernel)
+        last_core_ = trans.pid - ppid;
+    return last_core_;
+}
+
+bool HMTTCPU::FetchTrans(size_t core, HMTTTransaction &trans, double tCK) {
+    HMTTCore &c = cores_[core];
+    while(c.pending.empty()){
+        if(trace_end_){
+            trans.valid = false;
+            return true;
         }
+        //a transaction of this core read past its clock could not enter
+        //the ROB this cycle anyway
+        if(IsMultiCore() &&
+           (trace_ns_ - c.last_trace_ns + c.last_req_ns) > (c.clk * tCK))
+            return false;
+        HMTTTransaction next;
+        NextTrans(next);
+        trace_id++;
+        if(!next.valid){
+            trace_end_ = true;
+            continue;
+        }
+        //the trace is timed across all processes, a core only sees its own
+        trace_ns_ += next.added_ns;
+        HMTTCore &owner = cores_[CoreOf(next)];
+        next.added_ns = trace_ns_ - owner.last_trace_ns;
+        owner.last_trace_ns = trace_ns_;
+        owner.pending.push_back(next);
     }
+    trans = c.pending.front();
+    c.pending.pop_front();
+    return true;
+}
 
-    //check data dependency
-    bool is_depend = false;
-    if(wait != rob.end()){
-        for (auto i = rob.begin(); i != wait; ++i) {
-            if(i->addr == wait->addr){
-                is_depend = true;
-                break;
+void HMTTCPU::ClockTick() {
+    memory_system_.ClockTick();
+    memory_system_local.ClockTick();
+    double tCK = memory_system_.GetTCK();
+    bool valid = false;
+    for (size_t i = 0; i < cores_.size(); i++) {
+        HMTTCore &c = cores_[i];
+        if(c.get_next && c.tmp.valid){
+            if(!FetchTrans(i, c.tmp, tCK)){
+                //idle until its next transaction is due
+                valid = true;
+                continue;
             }
+            c.get_next = false;
+            //std::cout<<"["<<std::dec<<c.kernel_trace_count + c.app_trace_count<<"]: "<<c.tmp.added_ns
+            //<<" "<<std::hex<<c.tmp.addr<<(c.tmp.is_kernel ? " kernel" : " app")
+            //<<(c.tmp.r_w ? " Read": " Write")<<"\n"<<std::dec;
         }
-    }
-
-    if(!is_depend && outstanding < mshr_sz && wait != rob.end()){
-        MemorySystem *issued_to;
-        if(!wait->is_kernel){
-            issued_to = &memory_system_;
-        }else{
-            issued_to = &memory_system_local;
+        if(!c.tmp.valid)
+            continue;
+        valid = true;
+
+        //the other cores keep the wall clock busy, only a single core
+        //jumps over the gap to its next trace
+        if(c.rob.Empty() && !IsMultiCore()){
+            wall_clk += ceil(c.tmp.added_ns / tCK);
+            c.last_req_ns += c.tmp.added_ns;
+            c.tmp.added_ns = 0;
+            c.clk = ceil(c.last_req_ns / tCK);
+            //std::cout<<"fast forwarding to next trace "<<c.clk<<" "<<wall_clk<<"\n";
         }
 
-        if(issued_to->WillAcceptTransaction(wait->addr, wait->r_w == 0)){
-            issued_to->AddTransaction(wait->addr, wait->r_w == 0);
-            //std::cout<<std::hex<<wait->addr<<" is issued\n";
+        if((c.tmp.added_ns + c.last_req_ns) <= (c.clk * tCK)){
+            c.last_req_ns += c.tmp.added_ns;
+            c.tmp.added_ns = c.clk;
+            c.tmp.is_finished = false;
+            //c.tmp.addr = (c.tmp.addr >> 12) << 12;
+            c.rob.Push(c.tmp);
+            c.get_next = true;
+        }
+    }
 
-            if(!wait->is_kernel){
-                app_trace_count ++;
-            }else{
-                kernel_trace_count ++;
-            }
-            wait->issued_clk = wall_clk;
-            if(wait->r_w != 0){
-                outstanding ++;
-                read_outstanding[outstanding] ++;
-                wait ++;
-            }else{
-                if(wait == rob.begin()){
-                    wait = rob.erase(rob.begin());
-                }else{
-                    wait->is_finished = true;
-                    wait ++;
-                }
-            }
+    bool app_issued = false;
+    bool local_issued = false;
+    for (size_t i = 0; i < cores_.size(); i++) {
+        TryIssue(cores_[(issue_rr_ + i) % cores_.size()], app_issued, local_issued);
+    }
+    issue_rr_ = (issue_rr_ + 1) % cores_.size();
+
+    for (auto &c : cores_) {
+        if(c.rob.Empty() || (c.clk < (c.rob.Front().added_ns + rob_sz))){
+            //a core whose trace ended stops counting
+            if(c.tmp.valid || !c.rob.Empty() || !IsMultiCore())
+                c.clk++;
+            //std::cout<<c.clk<<" "<<(c.rob.Front().added_ns + rob_sz)<<"\n";
+        }else{
+            c.stall_clk++;
         }
     }
 
-    if(rob.empty() || (clk_ < (rob.front().added_ns + rob_sz))){
-        clk_++;
-        //std::cout<<clk_<<" "<<(rob.front().added_ns + rob_sz)<<"\n";
+    if(valid)
+        wall_clk ++;
+}
+
+bool HMTTCPU::TryIssue(HMTTCore &c, bool &app_issued, bool &local_issued) {
+    //check data dependency
+    if(c.rob.WaitingDepends() || c.outstanding >= mshr_sz || !c.rob.HasWaiting())
+        return false;
+    HMTTTransaction *wait = &c.rob.Waiting();
+    MemorySystem *issued_to;
+    bool *taken;
+    if(!wait->is_kernel){
+        issued_to = &memory_system_;
+        taken = &app_issued;
+    }else{
+        issued_to = &memory_system_local;
+        taken = &local_issued;
     }
+    if(*taken || !issued_to->WillAcceptTransaction(wait->addr, wait->r_w == 0))
+        return false;
 
+    issued_to->AddTransaction(wait->addr, wait->r_w == 0);
+    *taken = true;
+    //std::cout<<std::hex<<wait->addr<<" is issued\n";
 
-    if(tmp.valid)
-        wall_clk ++;
+    if(!wait->is_kernel){
+        c.app_trace_count ++;
+    }else{
+        c.kernel_trace_count ++;
+    }
+    wait->issued_clk = wall_clk;
+    if(wait->r_w != 0){
+        c.outstanding ++;
+        c.read_outstanding[c.outstanding] ++;
+        c.rob.Issue();
+    }else{
+        //writes finish once issued
+        wait->is_finished = true;
+        c.rob.Issue();
+        c.rob.Retire();
+    }
+    return true;
 }
 
 void HMTTCPU::ReadCallBack(uint64_t addr) {
-    auto res = std::find_if(rob.begin(), rob.end(), [addr](const HMTTTransaction a){
-        return a.addr == addr && a.r_w == 1;
-    });
-    if(res == rob.end()){
+    //cores may read the same address, the data goes to the first one
+    //still waiting for it
+    HMTTCore *owner = nullptr;
+    HMTTTransaction *res = nullptr;
+    for (auto &c : cores_) {
+        res = c.rob.FindIssuedRead(addr);
+        if(res != nullptr && (!res->is_finished || !IsMultiCore())){
+            owner = &c;
+            break;
+        }
+    }
+    if(owner == nullptr){
         std::cerr<<"redundant read data "<<addr<<"\n";
         AbruptExit(__FILE__, __LINE__);
     }
     res->is_finished = true;
-    outstanding --;
+    owner->outstanding --;
 
     if(res->r_w){
-        uint64_t latency = wall_clk - res->issued_clk;
-        if(read_latency.find(latency) == read_latency.end()){
-            read_latency[latency] = 1;
-        }else{
-            read_latency[latency] ++;
-        }
+        owner->read_latency.Add(wall_clk - res->issued_clk);
     }
 
-    for (auto i = rob.begin(); i != wait; ) {
-        if(i->is_finished)
-            i = rob.erase(i);
-        else
-            break;
+    owner->rob.Retire();
+    //std::cout<<std::hex<<addr<<" read finished "<<owner->rob.Size()<<" "<<owner->outstanding<<"\n";
+}
+
+uint64_t HMTTCPU::Outstanding() const {
+    uint64_t outstanding = 0;
+    for (auto &c : cores_) {
+        outstanding += c.outstanding;
     }
-    //std::cout<<std::hex<<addr<<" read finished "<<rob.size()<<" "<<outstanding<<"\n";
+    return outstanding;
 }
 
 void HMTTCPU::PrintStats() {
     memory_system_.PrintStats();
     memory_system_local.PrintStats();
+    SimpleStats::HistoCount read_outstanding;
+    for (auto &c : cores_) {
+        for (auto i = c.read_outstanding.begin(); i != c.read_outstanding.end(); ++i) {
+            read_outstanding[i->first] += i->second;
+        }
+    }
     std::cout<<"outstanding distribution: "<<"\n";
     for (int i = 0; i < mshr_sz; ++i) {
         std::cout<<i<<" "<<read_outstanding[i]<<"\n";
     }
-    std::cout<<std::dec<<"cpu clock: "<<clk_<<"\n";
-    std::cout<<std::dec<<"wall clock: "<<wall_clk<<"\n";
-    std::cout<<std::dec<<"kernel traces: "<<kernel_trace_count<<"\n";
-    std::cout<<std::dec<<"app traces: "<<app_trace_count<<"\n";
-    std::cout<<"System performance downgradation: "<<1.0 * (wall_clk - clk_) / clk_ * 100.0<<" %\n";
-    std::cout<<"average read latency: "<<SimpleStats::GetHistoAvg(read_latency) * memory_system_.GetTCK()<<"ns\n";
-
-    std::vector<uint64_t> bin(5, 0);
-    for (auto i = read_latency.begin(); i != read_latency.end(); ++i) {
-        if(i->first / 500 > 4)
-            bin[4] += i->second;
-        else
-            bin[i->first / 500] += i->second;
+    if(IsMultiCore()){
+        for (size_t i = 0; i < cores_.size(); i++) {
+            std::cout<<"core "<<i<<" (pid "<<ppid + i<<"):\n";
+            HMTTStats s = GetCoreStats(i);
+            if(s.kernel_traces + s.app_traces == 0){
+                std::cout<<"no transactions\n";
+                continue;
+            }
+            s.Print(std::cout);
+        }
+        std::cout<<"all cores:\n";
+    }
+    GetStats().Print(std::cout);
+    if(!sampled_stats_.Empty()){
+        sampled_stats_.Print(std::cout);
     }
-    std::cout<<"read latency distribution:\n"
-            <<"[0-500): "<<bin[0]<<"\n"
-            <<"[500-1000): "<<bin[1]<<"\n"
-            <<"[1000-1500): "<<bin[2]<<"\n"
-            <<"[1500-2000): "<<bin[3]<<"\n"
-            <<"[2000-): "<<bin[4]<<"\n";
 }
 
 bool HMTTCPU::IsEnd() {
-    if((kernel_trace_count + app_trace_count) > simulating){
+    if(GetTraceNum() > seg_length){
+        if(use_simpoint_){
+            Drained();
+            RecordSample();
+        }
         if(!GetNextSeg())
             return true;
         else{
@@ -303,25 +477,292 @@ bool HMTTCPU::IsEnd() {
 }
 
 uint64_t HMTTCPU::GetTraceNum() {
-    return kernel_trace_count + app_trace_count;
+    uint64_t num = 0;
+    for (auto &c : cores_) {
+        num += c.kernel_trace_count + c.app_trace_count;
+    }
+    return num;
 }
 
 uint64_t HMTTCPU::GetClk() {
     return wall_clk;
 }
 
+HMTTStats HMTTCPU::GetStats() const {
+    HMTTStats s;
+    if(IsMultiCore()){
+        //a core that got no transaction only adds idle clocks
+        for (size_t i = 0; i < cores_.size(); i++) {
+            HMTTStats core = GetCoreStats(i);
+            if(core.kernel_traces + core.app_traces > 0)
+                s.Merge(core);
+        }
+    }else{
+        s = GetCoreStats(0);
+        s.wall_clk = wall_clk;
+    }
+    memory_system_.GetCacheStat(s.hit, s.miss);
+    return s;
+}
+
+HMTTStats HMTTCPU::GetCoreStats(size_t core) const {
+    const HMTTCore &c = cores_[core];
+    HMTTStats s;
+    s.cpu_clk = c.clk;
+    s.wall_clk = c.clk + c.stall_clk;
+    s.kernel_traces = c.kernel_trace_count;
+    s.app_traces = c.app_trace_count;
+    s.tCK = memory_system_.GetTCK();
+    s.read_latency = c.read_latency;
+    return s;
+}
+
+void HMTTStats::Merge(const HMTTStats &s) {
+    cpu_clk += s.cpu_clk;
+    wall_clk += s.wall_clk;
+    kernel_traces += s.kernel_traces;
+    app_traces += s.app_traces;
+    hit += s.hit;
+    miss += s.miss;
+    tCK = s.tCK;
+    read_latency.Merge(s.read_latency);
+}
+
+void HMTTStats::Print(std::ostream &os) const {
+    os<<std::dec<<"cpu clock: "<<cpu_clk<<"\n";
+    os<<std::dec<<"wall clock: "<<wall_clk<<"\n";
+    os<<std::dec<<"kernel traces: "<<kernel_traces<<"\n";
+    os<<std::dec<<"app traces: "<<app_traces<<"\n";
+    if(hit + miss > 0){
+        os<<"cache hit: "<<hit<<"\n"
+          <<"cache miss: "<<miss<<"\n"
+          <<"cache miss rate: "<<100.0 * miss / (hit + miss)<<" %\n";
+    }
+    os<<"System performance downgradation: "
+      <<(cpu_clk == 0 ? 0.0 : 1.0 * (wall_clk - cpu_clk) / cpu_clk * 100.0)<<" %\n";
+    os<<"average read latency: "<<read_latency.Mean() * tCK<<"ns\n";
+    os<<"read latency distribution:\n";
+    for (auto &i : read_latency.Summary()) {
+        os<<i.first<<": "<<i.second * tCK<<"ns\n";
+    }
+}
+
 void HMTTCPU::WarmUp() {
     uint64_t s = cur_seg.sid;
+    uint64_t start = s > warmup_distance ? s - warmup_distance : 0;
+    //only the first warm-up starts from a cold cache
+    std::string checkpoint;
+    uint64_t key = 0;
+    if(!checkpoint_dir_.empty() && trace_id == 0 && s > 0 && memory_system_.HasCache()){
+        checkpoint = CheckpointPath(start, key);
+        if(LoadCheckpoint(checkpoint, key)){
+            if(use_prefetch_){
+                prefetcher_.Start();
+            }
+            std::cout<<std::dec<<"restored warmed caches at "<<trace_id<<" from "<<checkpoint<<"\n";
+            return;
+        }
+    }
+    if(trace_index_.IsOpen()){
+        const TraceIndexEntry *e = trace_index_.Find(start);
+        if(e != nullptr && e->id > trace_id){
+            prefetcher_.Stop();
+            if(use_cache_){
+                trace_cache_.Seek(trace_cache_.Header().num_p == 0 ? e->translated : e->id);
+            }else if(!trace_index_.Restore(trace_reader_, *e)){
+                AbruptExit(__FILE__, __LINE__);
+            }
+            trace_id = e->id;
+            std::cout<<std::dec<<"jumping to "<<trace_id<<"\n";
+        }
+    }
+    //the reader must stop at s when its position goes into a checkpoint
+    if(use_prefetch_ && checkpoint.empty()){
+        prefetcher_.Start();
+    }
+    HMTTTransaction trans;
     for (; trace_id < s; ++trace_id) {
-        GetNextHMTT(tmp, ppid, num_p);
-        if(!tmp.is_kernel)
-            memory_system_.WarmUp(tmp.addr, tmp.r_w == 0);
+        NextTrans(trans);
+        if(trace_id >= start && !trans.is_kernel)
+            memory_system_.WarmUp(trans.addr, trans.r_w == 0);
     }
     std::cout<<std::dec<<"warming up to "<<trace_id<<"\n";
+    if(!checkpoint.empty()){
+        SaveCheckpoint(checkpoint, key);
+        if(use_prefetch_){
+            prefetcher_.Start();
+        }
+    }
+}
+
+std::string HMTTCPU::CheckpointPath(uint64_t start, uint64_t &key) const {
+    CheckpointKey k;
+    k.Add(trace_file_);
+    if(use_cache_){
+        k.AddFileSize(trace_file_);
+    }else{
+        k.AddFileSize(trace_file_ + ".trace");
+        k.AddFileSize(trace_file_ + ".kt");
+    }
+    k.AddFile(config_file_);
+    k.Add(benchmark_);
+    k.Add(static_cast<uint64_t>(ppid));
+    k.Add(num_p);
+    k.Add(start);
+    k.Add(cur_seg.sid);
+    key = k.Value();
+    std::stringstream path;
+    path<<checkpoint_dir_<<"/"<<benchmark_<<"_"<<std::hex<<std::setw(16)<<std::setfill('0')<<key<<".ckpt";
+    return path.str();
+}
+
+void HMTTCPU::SaveCheckpoint(const std::string &path, uint64_t key) {
+    StateWriter w;
+    if(!w.Open(path, key, trace_id))
+        return;
+    if(use_cache_){
+        w.Put(trace_cache_.Position());
+    }else{
+        trace_reader_.SaveState(w.File());
+    }
+    memory_system_.SaveState(w);
+    if(w.Close())
+        std::cout<<"saved warmed caches to "<<path<<"\n";
+}
+
+bool HMTTCPU::LoadCheckpoint(const std::string &path, uint64_t key) {
+    StateReader r;
+    if(!r.Open(path, key))
+        return false;
+    //the caches are overwritten from here on, a broken file is fatal
+    bool ok;
+    if(use_cache_){
+        uint64_t position = 0;
+        ok = r.Get(position) && trace_cache_.Seek(position);
+    }else{
+        ok = trace_reader_.LoadState(r.File()) == 0;
+    }
+    if(!ok || !memory_system_.LoadState(r)){
+        std::cerr<<"corrupted checkpoint "<<path<<std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    trace_id = r.Header().trace_id;
+    return true;
+}
+
+bool HMTTCPU::UseIndex(const std::string &index_file) {
+    if(!trace_index_.Open(index_file))
+        return false;
+    const TraceIndexHeader &h = trace_index_.Header();
+    bool cache_ok = !use_cache_ || trace_cache_.Header().num_p == 0 ||
+                    (trace_cache_.Header().ppid == h.ppid && trace_cache_.Header().num_p == h.num_p);
+    if(h.ppid != ppid || h.num_p != num_p || !cache_ok){
+        std::cerr<<index_file<<" was built for another pid range, ignored\n";
+        trace_index_.Close();
+        return false;
+    }
+    return true;
+}
+
+void HMTTCPU::NextTrans(HMTTTransaction &trans) {
+    if(prefetcher_.IsRunning()){
+        prefetcher_.Next(trans);
+    }else{
+        ReadTrans(trans);
+    }
+}
+
+void HMTTCPU::ReadTrans(HMTTTransaction &trans) {
+    if(use_cache_){
+        trace_cache_.Next(trans, ppid, num_p);
+    }else{
+        trace_reader_.NextHMTT(trans, ppid, num_p);
+    }
+}
+
+uint64_t HMTTCPU::MemoryIdleCycles() const {
+    uint64_t next = memory_system_.NextEventCycle();
+    uint64_t next_local = memory_system_local.NextEventCycle();
+    if(next == UINT64_MAX && next_local == UINT64_MAX)
+        return UINT64_MAX;
+    return std::min(next - memory_system_.GetClk(),
+                    next_local - memory_system_local.GetClk());
+}
+
+uint64_t HMTTCPU::FastForward(uint64_t max_cycles) {
+    if(!fast_forward_ || max_cycles == 0)
+        return 0;
+    double tCK = memory_system_.GetTCK();
+    uint64_t skip = std::min(max_cycles, MemoryIdleCycles());
+    bool valid = false;
+    //the cycles each core can skip and where its clock stops
+    std::vector<uint64_t> limits(cores_.size(), UINT64_MAX);
+    for (size_t i = 0; i < cores_.size(); i++) {
+        HMTTCore &c = cores_[i];
+        valid |= c.tmp.valid;
+        //a multi-core core waiting in FetchTrans() reads on once its clock
+        //reaches the trace read so far
+        bool fetching = c.get_next && c.tmp.valid;
+        if(fetching && (!c.pending.empty() || trace_end_ || !IsMultiCore()))
+            return 0;
+        if(c.rob.Empty()){
+            //a single core jumps over the gap in ClockTick()
+            if(!c.tmp.valid)
+                continue;
+            if(!IsMultiCore())
+                return 0;
+        }
+        if(!c.rob.WaitingDepends() && c.outstanding < mshr_sz && c.rob.HasWaiting()){
+            HMTTTransaction &wait = c.rob.Waiting();
+            const MemorySystem &issued_to = wait.is_kernel ? memory_system_local : memory_system_;
+            if(issued_to.WillAcceptTransaction(wait.addr, wait.r_w == 0))
+                return 0;
+        }
+        if(!c.rob.Empty())
+            limits[i] = c.rob.Front().added_ns + rob_sz;
+        if(!c.tmp.valid)
+            continue;
+
+        //the pending transaction enters the ROB at the first clk where this
+        //holds, clk stops at the limit until the ROB head retires
+        uint64_t due = fetching ? trace_ns_ - c.last_trace_ns : c.tmp.added_ns;
+        auto entered = [&c, due, tCK](uint64_t clk) {
+            return (due + c.last_req_ns) <= (clk * tCK);
+        };
+        if(entered(c.clk))
+            return 0;
+        uint64_t enter = ceil((due + c.last_req_ns) / tCK);
+        while(!entered(enter)) enter++;
+        while(enter > c.clk + 1 && entered(enter - 1)) enter--;
+        if(enter <= limits[i])
+            skip = std::min(skip, enter - c.clk);
+    }
+    if(!valid || skip == 0)
+        return 0;
+
+    memory_system_.FastForward(memory_system_.GetClk() + skip);
+    memory_system_local.FastForward(memory_system_local.GetClk() + skip);
+    for (size_t i = 0; i < cores_.size(); i++) {
+        HMTTCore &c = cores_[i];
+        if(c.rob.Empty() && !c.tmp.valid)
+            continue;
+        uint64_t run = c.clk < limits[i] ? std::min(skip, limits[i] - c.clk) : 0;
+        c.clk += run;
+        c.stall_clk += skip - run;
+    }
+    issue_rr_ = (issue_rr_ + skip) % cores_.size();
+    wall_clk += skip;
+    return skip;
 }
 
 void HMTTCPU::Drained() {
-    while(outstanding != 0){
+    while(Outstanding() != 0){
+        uint64_t skip = fast_forward_ ? MemoryIdleCycles() : 0;
+        if(skip > 0 && skip != UINT64_MAX){
+            memory_system_.FastForward(memory_system_.GetClk() + skip);
+            memory_system_local.FastForward(memory_system_local.GetClk() + skip);
+            wall_clk += skip;
+        }
         memory_system_local.ClockTick();
         memory_system_.ClockTick();
         wall_clk++;
@@ -329,37 +770,47 @@ void HMTTCPU::Drained() {
 }
 
 bool HMTTCPU::GetNextSeg() {
-    //TODO: we only process one window for now
-    if(segment_count == 1)
-        return false;
-    //select the proper segment
-    if(!seg_file_.eof()){
-        seg_file_>>cur_seg;
+    if(use_simpoint_){
+        if(!(seg_file_>>cur_point))
+            return false;
+        cur_seg = WorkingSet(cur_point.sid, cur_point.eid, 0);
+        seg_length = cur_point.eid - cur_point.sid;
         segment_count++;
+        std::cout<<std::dec<<"simulation point "<<segment_count<<" at "<<cur_point.sid
+                 <<", weight "<<cur_point.weight<<"\n";
         return true;
     }
+    //one segment per instance
     return false;
 }
 
+void HMTTCPU::RecordSample() {
+    HMTTStats s = GetStats();
+    //a window without transactions has no slowdown to weigh in
+    if(s.cpu_clk == 0){
+        std::cout<<std::dec<<"simulation point "<<segment_count
+                 <<" has no transactions, not sampled\n";
+        return;
+    }
+    sampled_stats_.Add(cur_point, {(double)s.cpu_clk, (double)s.wall_clk,
+                                   s.read_latency.Mean() * s.tCK,
+                                   100.0 * (s.wall_clk - s.cpu_clk) / s.cpu_clk});
+}
+
 void HMTTCPU::Reset() {
     memory_system_.ResetStats();
 
-    //base class
-    clk_ = 0;
-    get_next_ = true;
-
     //derived class
-    kernel_trace_count = 0;
-    app_trace_count = 0;
     wall_clk = 0;
-    for (int i = 0; i < mshr_sz; ++i) {
-        read_outstanding[i] = 0;
+    for (auto &c : cores_) {
+        //read ahead and counted in trace_id, they warm the caches like the
+        //rest of the trace up to the next segment
+        for (auto &t : c.pending) {
+            if(!t.is_kernel)
+                memory_system_.WarmUp(t.addr, t.r_w == 0);
+        }
+        c.Reset();
     }
-    read_latency.clear();
-
-    last_req_ns = 0;
-    outstanding = 0;
-    rob.clear();
-    wait = rob.end();
+    trace_ns_ = 0;
 }
 }  // namespace dramsim3
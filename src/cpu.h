@@ -1,6 +1,7 @@
 #ifndef __CPU_H
 #define __CPU_H
 
+#include <deque>
 #include <fstream>
 #include <functional>
 #include <random>
@@ -9,6 +10,13 @@
 #include <utility>
 #include "memory_system.h"
 #include "working_size.h"
+#include "trace.h"
+#include "trace_cache.h"
+#include "trace_index.h"
+#include "trace_prefetcher.h"
+#include "simpoint.h"
+#include "reorder_buffer.h"
+#include "log_histogram.h"
 
 namespace dramsim3 {
 
@@ -77,6 +85,51 @@ class TraceBasedCPU : public CPU {
     bool get_next_ = true;
 };
 
+//stats of a simulated segment, segments run apart are merged as if they
+//were simulated back to back
+class HMTTStats {
+   public:
+    uint64_t cpu_clk = 0;
+    uint64_t wall_clk = 0;
+    uint64_t kernel_traces = 0;
+    uint64_t app_traces = 0;
+    uint64_t hit = 0;
+    uint64_t miss = 0;
+    double tCK = 0;
+    LogHistogram read_latency;
+    void Merge(const HMTTStats &s);
+    void Print(std::ostream &os) const;
+};
+
+//one ROB/MSHR stream of the trace. HMTTCPU replays the whole trace on one
+//core, or in multi-core mode gives every process of [ppid, ppid+num_p) its
+//own core in front of the shared memory systems
+class HMTTCore {
+   public:
+    explicit HMTTCore(size_t rob_capacity) : rob(rob_capacity) { Reset(); }
+    void Reset();
+
+    HMTTTransaction tmp;
+    bool get_next;
+    uint64_t last_req_ns;
+    ReorderBuffer rob;
+    uint64_t outstanding;
+    uint64_t clk;
+    //cycles clk was held back by the ROB head
+    uint64_t stall_clk;
+    //transactions of this core read ahead of another core's, added_ns is
+    //already relative to the previous one of this core
+    std::deque<HMTTTransaction> pending;
+    //trace time of the last transaction handed to this core
+    uint64_t last_trace_ns;
+
+    //statics
+    uint64_t kernel_trace_count;
+    uint64_t app_trace_count;
+    SimpleStats::HistoCount read_outstanding;
+    LogHistogram read_latency;
+};
+
 class HMTTCPU : public CPU {
    private:
     const int rob_sz ;
@@ -86,42 +139,110 @@ class HMTTCPU : public CPU {
     const int ppid;
     const uint64_t num_p;
     //const double clk_ns = 0.5; //2GHz
-    HMTTTransaction tmp;
-    uint64_t last_req_ns;
-    std::list<HMTTTransaction> rob;
-    std::list<HMTTTransaction>::iterator wait;
-    uint64_t outstanding;
     MemorySystem memory_system_local;
-    bool get_next_ = true;
+
+    //a single core, or one per process; kernel transactions go to the core
+    //of the last application transaction. Cores issue round-robin, each
+    //memory system takes one transaction per cycle
+    std::vector<HMTTCore> cores_;
+    size_t last_core_;
+    size_t issue_rr_;
+    //trace time of the last transaction read, and whether it was the end
+    uint64_t trace_ns_;
+    bool trace_end_;
+    bool IsMultiCore() const { return cores_.size() > 1; }
+    size_t CoreOf(const HMTTTransaction &trans);
+    //false if the core has nothing up to its clock yet, the trace is only
+    //read that far ahead for the other cores
+    bool FetchTrans(size_t core, HMTTTransaction &trans, double tCK);
+    bool TryIssue(HMTTCore &core, bool &app_issued, bool &local_issued);
+    uint64_t Outstanding() const;
 
     //Global variables
     std::ifstream seg_file_;
     WorkingSet cur_seg;
     uint64_t trace_id;
     uint64_t segment_count;
+    uint64_t seg_length;
     bool GetNextSeg();
     void Reset();
 
+    //sampling mode: the segment file is a .simpt written by simpoint, every
+    //point is simulated and the stats are weighted by cluster size
+    bool use_simpoint_;
+    SimPoint cur_point;
+    SampledStats sampled_stats_;
+    void RecordSample();
+
+    //raw trace, or pre-translated input when the trace file is a .htc
+    TraceReader trace_reader_;
+    bool use_cache_;
+    TraceCacheReader trace_cache_;
+    void ReadTrans(HMTTTransaction &trans);
+    void NextTrans(HMTTTransaction &trans);
+
+    //decodes ahead on its own thread once the segment start is known
+    TracePrefetcher prefetcher_;
+    bool use_prefetch_;
+
+    //skip idle cycles of the memory systems in one step
+    bool fast_forward_;
+    uint64_t MemoryIdleCycles() const;
+
+    //seekable index, warm up only warmup_distance ids before the segment
+    TraceIndex trace_index_;
+    uint64_t warmup_distance;
+
+    //the cache and trace position after warming up a cold cache are kept
+    //in checkpoint_dir_, keyed by what the warm-up depends on
+    std::string checkpoint_dir_;
+    std::string config_file_;
+    std::string trace_file_;
+    std::string benchmark_;
+    std::string CheckpointPath(uint64_t start, uint64_t &key) const;
+    void SaveCheckpoint(const std::string &path, uint64_t key);
+    bool LoadCheckpoint(const std::string &path, uint64_t key);
+
     //statics
-    uint64_t kernel_trace_count;
-    uint64_t app_trace_count;
     uint64_t  wall_clk;
-    SimpleStats::HistoCount read_outstanding;
-    SimpleStats::HistoCount read_latency;
+
+    HMTTCPU(const std::string& config_file, const std::string& output_dir,
+                  const std::string& trace_file, int ppid_, uint64_t num_p_, bool use_mmap);
 
    public:
     HMTTCPU(const std::string& config_file, const std::string& output_dir,
                   const std::string& trace_file, const std::string &seg_file,
-                  int ppid_, uint64_t num_p_);
-    ~HMTTCPU() {seg_file_.close(); trace_finish(); std::cout<<"destory HMTTCPU\n";};
+                  int ppid_, uint64_t num_p_, bool use_mmap = true);
+    //simulate only `seg`, so that segments can run on separate instances
+    HMTTCPU(const std::string& config_file, const std::string& output_dir,
+                  const std::string& trace_file, const WorkingSet &seg,
+                  int ppid_, uint64_t num_p_, bool use_mmap = true);
+    static std::vector<WorkingSet> ReadSegments(const std::string &seg_file);
+    ~HMTTCPU() {prefetcher_.Stop(); seg_file_.close(); if(!use_cache_) trace_reader_.Finish(); std::cout<<"destory HMTTCPU\n";};
     void ClockTick() override;
     void ReadCallBack(uint64_t addr) override;
     void PrintStats() override;
     bool IsEnd();
     uint64_t GetTraceNum();
     uint64_t GetClk();
+    HMTTStats GetStats() const;
+    //a core runs against its own clock, its wall clock is that clock plus
+    //the cycles it stalled, so the slowdown is the core's own
+    HMTTStats GetCoreStats(size_t core) const;
+    size_t CoreNum() const { return cores_.size(); }
+    //one core per process instead of one for the whole trace, call before
+    //WarmUp()
+    void SetMultiCore(bool enable);
     void WarmUp();
     void Drained();
+    bool UseIndex(const std::string &index_file);
+    void SetWarmUpDistance(uint64_t distance) { warmup_distance = distance; }
+    void SetCheckpointDir(const std::string &dir) { checkpoint_dir_ = dir; }
+    void SetPrefetch(bool enable) { use_prefetch_ = enable; }
+    //skips up to max_cycles cycles in which ClockTick() would only wait
+    //for the memory systems, returns the cycles skipped
+    uint64_t FastForward(uint64_t max_cycles);
+    void SetFastForward(bool enable) { fast_forward_ = enable; }
 };
 
 }  // namespace dramsim3
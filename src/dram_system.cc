@@ -1,6 +1,7 @@
 #include "dram_system.h"
 
 #include <assert.h>
+#include <algorithm>
 
 namespace dramsim3 {
 
@@ -19,7 +20,8 @@ BaseDRAMSystem::BaseDRAMSystem(Config &config, const std::string &output_dir,
 #ifdef THERMAL
       thermal_calc_(config_),
 #endif  // THERMAL
-      clk_(0) {
+      clk_(0),
+      epoch_records_(0) {
     total_channels_ += config_.channels;
 
 #ifdef ADDR_TRACE
@@ -35,14 +37,24 @@ int BaseDRAMSystem::GetChannel(uint64_t hex_addr) const {
 
 void BaseDRAMSystem::PrintEpochStats() {
     // first epoch, print bracket
-    if (clk_ - config_.epoch_period == 0) {
-        std::ofstream epoch_out(config_.json_epoch_name, std::ofstream::out);
-        epoch_out << "[";
+    if (!epoch_out_.IsOpen()) {
+        epoch_out_.Open(config_.json_epoch_name);
+        if (config_.epoch_format == "json") {
+            epoch_out_ << "[";
+        } else if (config_.epoch_format == "binary") {
+            epoch_out_.Write(kEpochMagic, sizeof(kEpochMagic));
+        }
+        epoch_records_ = 0;
     }
     for (size_t i = 0; i < ctrls_.size(); i++) {
-        ctrls_[i]->PrintEpochStats();
-        std::ofstream epoch_out(config_.json_epoch_name, std::ofstream::app);
-        epoch_out << "," << std::endl;
+        if (config_.epoch_format == "json" && epoch_records_ > 0) {
+            epoch_out_ << ",\n";
+        }
+        ctrls_[i]->PrintEpochStats(&epoch_out_);
+        if (config_.epoch_format == "jsonl") {
+            epoch_out_ << "\n";
+        }
+        epoch_records_++;
     }
 #ifdef THERMAL
     thermal_calc_.PrintTransPT(clk_);
@@ -51,13 +63,13 @@ void BaseDRAMSystem::PrintEpochStats() {
 }
 
 void BaseDRAMSystem::PrintStats() {
-    // Finish epoch output, remove last comma and append ]
-    std::ofstream epoch_out(config_.json_epoch_name, std::ios_base::in |
-                                                         std::ios_base::out |
-                                                         std::ios_base::ate);
-    epoch_out.seekp(-2, std::ios_base::cur);
-    epoch_out.write("]", 1);
-    epoch_out.close();
+    // Finish epoch output, append ]
+    if (epoch_out_.IsOpen()) {
+        if (config_.epoch_format == "json") {
+            epoch_out_ << "]\n";
+        }
+        epoch_out_.Close();
+    }
 
     std::ofstream json_out(config_.json_stats_name, std::ofstream::out);
     json_out << "{";
@@ -96,7 +108,8 @@ void BaseDRAMSystem::RegisterCallbacks(
 JedecDRAMSystem::JedecDRAMSystem(Config &config, const std::string &output_dir,
                                  std::function<void(uint64_t)> read_callback,
                                  std::function<void(uint64_t)> write_callback)
-    : BaseDRAMSystem(config, output_dir, read_callback, write_callback) {
+    : BaseDRAMSystem(config, output_dir, read_callback, write_callback),
+      tick_pool_(nullptr) {
     if (config_.IsHMC()) {
         std::cerr << "Initialized a memory system with an HMC config file!"
                   << std::endl;
@@ -111,9 +124,20 @@ JedecDRAMSystem::JedecDRAMSystem(Config &config, const std::string &output_dir,
         ctrls_.push_back(new Controller(i, config_, timing_));
 #endif  // THERMAL
     }
+
+    int threads = std::min(config_.tick_threads, config_.channels);
+#ifdef THERMAL
+    // the thermal calculator is shared by all controllers
+    threads = 1;
+#endif  // THERMAL
+    if (threads > 1) {
+        tick_pool_ = new TickPool(threads);
+        tick_channel_ = [this](size_t i) { ctrls_[i]->ClockTick(); };
+    }
 }
 
 JedecDRAMSystem::~JedecDRAMSystem() {
+    delete tick_pool_;
     for (auto it = ctrls_.begin(); it != ctrls_.end(); it++) {
         delete (*it);
     }
@@ -158,8 +182,12 @@ void JedecDRAMSystem::ClockTick() {
             }
         }
     }
-    for (size_t i = 0; i < ctrls_.size(); i++) {
-        ctrls_[i]->ClockTick();
+    if (tick_pool_ != nullptr) {
+        tick_pool_->Run(ctrls_.size(), tick_channel_);
+    } else {
+        for (size_t i = 0; i < ctrls_.size(); i++) {
+            ctrls_[i]->ClockTick();
+        }
     }
     clk_++;
 
@@ -169,6 +197,24 @@ void JedecDRAMSystem::ClockTick() {
     return;
 }
 
+uint64_t JedecDRAMSystem::NextEventCycle() const {
+    // the tick ending an epoch prints its stats; controllers tick with the
+    // system, so their clocks are ours
+    uint64_t next = (clk_ / config_.epoch_period + 1) * config_.epoch_period - 1;
+    for (size_t i = 0; i < ctrls_.size() && next > clk_; i++) {
+        next = std::min(next, ctrls_[i]->NextEventCycle());
+    }
+    return next;
+}
+
+void JedecDRAMSystem::FastForward(uint64_t clk) {
+    if (clk <= clk_) return;
+    for (size_t i = 0; i < ctrls_.size(); i++) {
+        ctrls_[i]->FastForward(clk);
+    }
+    clk_ = clk;
+}
+
 IdealDRAMSystem::IdealDRAMSystem(Config &config, const std::string &output_dir,
                                  std::function<void(uint64_t)> read_callback,
                                  std::function<void(uint64_t)> write_callback)
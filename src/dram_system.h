@@ -8,6 +8,8 @@
 #include "common.h"
 #include "configuration.h"
 #include "controller.h"
+#include "stats_sink.h"
+#include "tick_pool.h"
 #include "timing.h"
 
 #ifdef THERMAL
@@ -32,6 +34,13 @@ class BaseDRAMSystem {
                                        bool is_write) const = 0;
     virtual bool AddTransaction(uint64_t hex_addr, bool is_write) = 0;
     virtual void ClockTick() = 0;
+    // Idle spans are skipped in one step: NextEventCycle() is the first
+    // clock whose ClockTick() changes more than clocks and idle counters
+    // (the current clock if busy), FastForward() advances to a clock no
+    // later than that. Systems without it are never idle.
+    virtual uint64_t NextEventCycle() const { return clk_; }
+    virtual void FastForward(uint64_t clk) {}
+    uint64_t GetClk() const { return clk_; }
     int GetChannel(uint64_t hex_addr) const;
 
     std::function<void(uint64_t req_id)> read_callback_, write_callback_;
@@ -52,6 +61,10 @@ class BaseDRAMSystem {
     uint64_t clk_;
     std::vector<Controller*> ctrls_;
 
+    // epoch stats of all channels, written in the background
+    StatsSink epoch_out_;
+    uint64_t epoch_records_;
+
 #ifdef ADDR_TRACE
     std::ofstream address_trace_;
 #endif  // ADDR_TRACE
@@ -67,7 +80,15 @@ class JedecDRAMSystem : public BaseDRAMSystem {
     bool WillAcceptTransaction(uint64_t hex_addr, bool is_write) const override;
     bool AddTransaction(uint64_t hex_addr, bool is_write) override;
     void ClockTick() override;
+    uint64_t NextEventCycle() const override;
+    void FastForward(uint64_t clk) override;
     friend class FrontEnd;
+
+   private:
+    // ticks the controllers in parallel if tick_threads > 1; completions
+    // are still returned in channel order before that
+    TickPool *tick_pool_;
+    std::function<void(size_t)> tick_channel_;
 };
 
 // Model a memorysystem with an infinite bandwidth and a fixed latency (possibly
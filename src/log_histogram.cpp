@@ -0,0 +1,101 @@
+#include "log_histogram.h"
+#include <math.h>
+#include <algorithm>
+
+namespace dramsim3 {
+
+LogHistogram::LogHistogram(int sub_bits)
+    : sub_bits_(std::min(std::max(sub_bits, 1), 16)),
+      half_(1ULL << (sub_bits_ - 1)) {
+    Clear();
+}
+
+size_t LogHistogram::Index(uint64_t value) const {
+    if (value < (half_ << 1)) {
+        return value;
+    }
+    // keep the top sub_bits bits of the value
+    int shift = 63 - __builtin_clzll(value) - (sub_bits_ - 1);
+    return (half_ << 1) + (shift - 1) * half_ + ((value >> shift) - half_);
+}
+
+uint64_t LogHistogram::Low(size_t index) const {
+    if (index < (half_ << 1)) {
+        return index;
+    }
+    uint64_t shift = (index - (half_ << 1)) / half_ + 1;
+    uint64_t top = (index - (half_ << 1)) % half_ + half_;
+    return top << shift;
+}
+
+uint64_t LogHistogram::High(size_t index) const {
+    if (index < (half_ << 1)) {
+        return index;
+    }
+    uint64_t shift = (index - (half_ << 1)) / half_ + 1;
+    return Low(index) + ((1ULL << shift) - 1);
+}
+
+void LogHistogram::Add(uint64_t value, uint64_t count) {
+    if (count == 0) return;
+    size_t i = Index(value);
+    if (i >= counts_.size()) {
+        counts_.resize(i + 1, 0);
+    }
+    counts_[i] += count;
+    if (count_ == 0 || value < min_) min_ = value;
+    max_ = std::max(max_, value);
+    count_ += count;
+    sum_ += value * count;
+}
+
+void LogHistogram::Merge(const LogHistogram &h) {
+    if (h.count_ == 0) return;
+    if (h.sub_bits_ != sub_bits_) {
+        h.ForEach([this](uint64_t low, uint64_t, uint64_t count) {
+            counts_.resize(std::max(counts_.size(), Index(low) + 1), 0);
+            counts_[Index(low)] += count;
+        });
+    } else {
+        counts_.resize(std::max(counts_.size(), h.counts_.size()), 0);
+        for (size_t i = 0; i < h.counts_.size(); i++) {
+            counts_[i] += h.counts_[i];
+        }
+    }
+    if (count_ == 0 || h.min_ < min_) min_ = h.min_;
+    max_ = std::max(max_, h.max_);
+    count_ += h.count_;
+    sum_ += h.sum_;
+}
+
+void LogHistogram::Clear() {
+    counts_.clear();
+    count_ = 0;
+    sum_ = 0;
+    min_ = 0;
+    max_ = 0;
+}
+
+uint64_t LogHistogram::Percentile(double p) const {
+    if (count_ == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(ceil(p / 100.0 * count_));
+    rank = std::min(std::max<uint64_t>(rank, 1), count_);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts_.size(); i++) {
+        seen += counts_[i];
+        if (seen >= rank) {
+            return std::min(High(i), max_);
+        }
+    }
+    return max_;
+}
+
+std::vector<std::pair<std::string, uint64_t>> LogHistogram::Summary() const {
+    return {{"p50", Percentile(50)},
+            {"p90", Percentile(90)},
+            {"p99", Percentile(99)},
+            {"p99.9", Percentile(99.9)},
+            {"max", Max()}};
+}
+
+}  // namespace dramsim3
@@ -0,0 +1,59 @@
+#ifndef DRAMSIM3_LOG_HISTOGRAM_H
+#define DRAMSIM3_LOG_HISTOGRAM_H
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dramsim3 {
+
+// HDR-style log-linear histogram of non-negative values. Values below
+// 2^sub_bits get a bucket each; above that every power of two is split
+// into 2^(sub_bits-1) buckets, so a bucket is within 2^-(sub_bits-1) of
+// its values. The bucket array only grows up to the largest value seen
+// and never beyond ~60 KB, adding is an index computation. Count, sum,
+// min and max are exact.
+class LogHistogram {
+   public:
+    explicit LogHistogram(int sub_bits = 8);
+    void Add(uint64_t value, uint64_t count = 1);
+    void Merge(const LogHistogram &h);
+    void Clear();
+
+    bool Empty() const { return count_ == 0; }
+    uint64_t Count() const { return count_; }
+    uint64_t Sum() const { return sum_; }
+    uint64_t Min() const { return count_ == 0 ? 0 : min_; }
+    uint64_t Max() const { return max_; }
+    double Mean() const { return count_ == 0 ? 0.0 : 1.0 * sum_ / count_; }
+    // the highest value of the bucket holding the p-th percentile, never
+    // above Max()
+    uint64_t Percentile(double p) const;
+    // p50, p90, p99, p99.9 and max
+    std::vector<std::pair<std::string, uint64_t>> Summary() const;
+
+    // fn(lowest value, highest value, count) of the non-empty buckets in
+    // increasing order
+    template <typename F>
+    void ForEach(F fn) const {
+        for (size_t i = 0; i < counts_.size(); i++) {
+            if (counts_[i] != 0) fn(Low(i), High(i), counts_[i]);
+        }
+    }
+
+   private:
+    size_t Index(uint64_t value) const;
+    uint64_t Low(size_t index) const;
+    uint64_t High(size_t index) const;
+
+    int sub_bits_;
+    uint64_t half_;
+    std::vector<uint64_t> counts_;
+    uint64_t count_;
+    uint64_t sum_;
+    uint64_t min_;
+    uint64_t max_;
+};
+
+}  // namespace dramsim3
+#endif  // DRAMSIM3_LOG_HISTOGRAM_H
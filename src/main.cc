@@ -2,9 +2,48 @@
 #include "./../ext/headers/args.hxx"
 #include "cpu.h"
 #include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <sys/stat.h>
 
 using namespace dramsim3;
 
+static void Simulate(HMTTCPU *cpu, uint64_t cycles, const std::string &tag) {
+    cpu->WarmUp();
+    uint64_t last_trace = 0;
+    uint64_t report = 0;
+    for (uint64_t clk = 0; clk < cycles && (!(cpu)->IsEnd()); clk++) {
+        clk += cpu->FastForward(cycles - clk - 1);
+        cpu->ClockTick();
+        if(clk >= report){
+            report = (clk / 1000000 + 1) * 1000000;
+            std::cout<<tag<<"processing "<<std::dec<<clk<<" clks and "<<(cpu)->GetTraceNum()<<" traces "
+            <<(cpu)->GetTraceNum() - last_trace<<" delta "
+            <<(cpu)->GetClk()<<" wall clks\n"<<std::flush;
+            last_trace = (cpu)->GetTraceNum();
+        }
+    }
+    (cpu)->Drained();
+}
+
+// <output_dir>/seg<i>/<benchmark>, the cache is sized by the last component
+static std::string SegmentDir(const std::string &output_dir, size_t i) {
+    std::string bench = output_dir.substr(output_dir.find_last_of('/') + 1);
+    std::string dir = output_dir + "/seg" + std::to_string(i);
+    mkdir(dir.c_str(), 0755);
+    dir += "/" + bench;
+    mkdir(dir.c_str(), 0755);
+    mkdir((dir + "/local").c_str(), 0755);
+    mkdir((dir + "/remote").c_str(), 0755);
+    if(!DirExist(dir)){
+        std::cerr << "cannot create " << dir << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    return dir;
+}
+
 int main(int argc, const char **argv) {
     args::ArgumentParser parser(
         "DRAM Simulator.",
@@ -24,12 +63,46 @@ int main(int argc, const char **argv) {
         {'s', "stream"}, "");
     args::ValueFlag<std::string> trace_file_arg(
         parser, "trace",
-        "Trace file, setting this option will ignore -s option",
+        "Trace file (prefix of .trace/.kt, or a .htc trace cache), "
+        "setting this option will ignore -s option",
         {'t', "trace"});
     args::ValueFlag<std::string> seg_file_arg(
         parser, "segment",
-        "segment file",
+        "segment file: a .seg of trace_seg/trace_profile (ppid #proc sid eid "
+        "...), a .ws of working_size/trace_profile (count, then sid eid "
+        "#pages ns), or a .simpt of simpoint to simulate every simulation "
+        "point",
         {'S', "seg"});
+    args::ValueFlag<std::string> index_file_arg(
+        parser, "index", "Seekable trace index (.hti) built by trace_index",
+        {"index"});
+    args::ValueFlag<uint64_t> warmup_arg(
+        parser, "warmup",
+        "Trace ids replayed for warm-up before the segment, whole prefix by default",
+        {'w', "warmup"}, UINT64_MAX);
+    args::ValueFlag<std::string> checkpoint_arg(
+        parser, "checkpoint",
+        "Directory of warmed cache checkpoints, one per trace, segment, "
+        "warm-up start and config",
+        {"checkpoint-dir"});
+    args::Flag no_mmap_arg(parser, "no_mmap",
+                           "Read the HMTT trace with stdio instead of mmap",
+                           {"no-mmap"});
+    args::Flag no_prefetch_arg(parser, "no_prefetch",
+                               "Decode the trace on the simulation thread",
+                               {"no-prefetch"});
+    args::Flag no_fast_forward_arg(parser, "no_fast_forward",
+                                   "Tick every cycle instead of skipping idle ones",
+                                   {"no-fast-forward"});
+    args::Flag multi_core_arg(parser, "multi_core",
+                              "One ROB and MSHR per process of the pid file, "
+                              "sharing the memory systems",
+                              {"multi-core"});
+    args::ValueFlag<unsigned> jobs_arg(
+        parser, "jobs",
+        "Segments simulated in parallel, each with its own memory system "
+        "under <output_dir>/seg<i>",
+        {'j', "jobs"}, std::thread::hardware_concurrency());
     args::Positional<std::string> config_arg(
         parser, "config", "The config file name (mandatory)");
 
@@ -66,30 +139,95 @@ int main(int argc, const char **argv) {
     pid_file_.close();
 
 
-    HMTTCPU *cpu;
-    if(!trace_file.empty() && !seg_file.empty()){
-        std::cout<<seg_file<<"\n";
-        cpu = new HMTTCPU(config_file, output_dir, trace_file, seg_file, ppid, num_p);
-    } else {
+    if(trace_file.empty() || seg_file.empty()){
         std::cerr << "Trace file and segment file does not provided" << std::endl;
         AbruptExit(__FILE__, __LINE__);
     }
+    std::cout<<seg_file<<"\n";
+    std::string index_file = args::get(index_file_arg);
+    auto setup = [&](HMTTCPU *cpu) {
+        if(!index_file.empty() && !cpu->UseIndex(index_file)){
+            std::cerr << "running without trace index" << std::endl;
+        }
+        cpu->SetWarmUpDistance(args::get(warmup_arg));
+        cpu->SetCheckpointDir(args::get(checkpoint_arg));
+        if(no_prefetch_arg){
+            cpu->SetPrefetch(false);
+        }
+        if(no_fast_forward_arg){
+            cpu->SetFastForward(false);
+        }
+        if(multi_core_arg){
+            cpu->SetMultiCore(true);
+        }
+    };
 
-    cpu->WarmUp();
-    uint64_t last_trace = 0;
-    for (uint64_t clk = 0; clk < cycles && (!(cpu)->IsEnd()); clk++) {
-        cpu->ClockTick();
-        if(clk % 1000000 == 0){
-            std::cout<<"processing "<<std::dec<<clk<<" clks and "<<(cpu)->GetTraceNum()<<" traces "
-            <<(cpu)->GetTraceNum() - last_trace<<" delta "
-            <<(cpu)->GetClk()<<" wall clks\n"<<std::flush;
-            last_trace = (cpu)->GetTraceNum();
+    std::vector<WorkingSet> segs;
+    if(seg_file.size() < 6 || seg_file.compare(seg_file.size() - 6, 6, ".simpt") != 0){
+        segs = HMTTCPU::ReadSegments(seg_file);
+        if(segs.empty()){
+            std::cerr << "Segment does not exist" << std::endl;
+            AbruptExit(__FILE__, __LINE__);
         }
     }
-    (cpu)->Drained();
-    cpu->PrintStats();
+    if(segs.size() <= 1){
+        //a single segment, or the simulation points of a .simpt in turn
+        HMTTCPU *cpu;
+        if(segs.empty())
+            cpu = new HMTTCPU(config_file, output_dir, trace_file, seg_file, ppid, num_p, !no_mmap_arg);
+        else
+            cpu = new HMTTCPU(config_file, output_dir, trace_file, segs[0], ppid, num_p, !no_mmap_arg);
+        setup(cpu);
+        Simulate(cpu, cycles, "");
+        cpu->PrintStats();
+        delete (cpu);
+        return 0;
+    }
+
+    //every segment gets its own caches and trace reader; construction and
+    //printing are serialized since the memory systems share statics and
+    //std::cout
+    std::vector<HMTTStats> stats(segs.size());
+    std::vector<std::string> dirs;
+    for (size_t i = 0; i < segs.size(); i++) {
+        dirs.push_back(SegmentDir(output_dir, i));
+    }
+    std::mutex serial;
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+    unsigned jobs = std::min<size_t>(std::max(args::get(jobs_arg), 1u), segs.size());
+    for (unsigned j = 0; j < jobs; j++) {
+        workers.emplace_back([&]() {
+            for (size_t i = next++; i < segs.size(); i = next++) {
+                std::string tag = "[seg " + std::to_string(i) + "] ";
+                HMTTCPU *cpu;
+                {
+                    std::lock_guard<std::mutex> lock(serial);
+                    std::cout<<tag<<"simulating from "<<segs[i].sid<<" in "<<dirs[i]<<"\n";
+                    cpu = new HMTTCPU(config_file, dirs[i], trace_file, segs[i], ppid, num_p, !no_mmap_arg);
+                    setup(cpu);
+                }
+                Simulate(cpu, cycles, tag);
+                stats[i] = cpu->GetStats();
+                {
+                    std::lock_guard<std::mutex> lock(serial);
+                    std::cout<<tag<<"stats\n";
+                    cpu->PrintStats();
+                    delete (cpu);
+                }
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
 
-    delete (cpu);
+    HMTTStats total;
+    for (auto &s : stats) {
+        total.Merge(s);
+    }
+    std::cout<<"combined stats of "<<segs.size()<<" segments\n";
+    total.Print(std::cout);
 
     return 0;
 }
@@ -0,0 +1,147 @@
+#include "mapped_file.h"
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+
+namespace dramsim3 {
+
+const uint64_t MappedFile::kWindowAlign;
+const uint64_t MappedFile::kWindowSize;
+
+MappedFile::MappedFile()
+    : fd_(-1),
+      fp_(NULL),
+      size_(0),
+      pos_(0),
+      win_(NULL),
+      win_off_(0),
+      win_len_(0) {}
+
+MappedFile::~MappedFile() { Close(); }
+
+bool MappedFile::Open(const char *path, bool use_mmap) {
+    Close();
+    if (use_mmap) {
+        fd_ = open(path, O_RDONLY);
+        if (fd_ >= 0) {
+            struct stat st;
+            if (fstat(fd_, &st) == 0 && S_ISREG(st.st_mode)) {
+                size_ = st.st_size;
+                if (size_ == 0 || MapWindow(0)) {
+                    return true;
+                }
+            }
+            close(fd_);
+            fd_ = -1;
+        }
+    }
+    fp_ = fopen(path, "rb");
+    if (fp_ == NULL) {
+        return false;
+    }
+    fseeko(fp_, 0, SEEK_END);
+    size_ = ftello(fp_);
+    fseeko(fp_, 0, SEEK_SET);
+    return true;
+}
+
+void MappedFile::Close() {
+    Unmap();
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+    if (fp_ != NULL) {
+        fclose(fp_);
+        fp_ = NULL;
+    }
+    size_ = 0;
+    pos_ = 0;
+}
+
+void MappedFile::Unmap() {
+    if (win_ != NULL) {
+        munmap(win_, win_len_);
+        win_ = NULL;
+    }
+    win_off_ = 0;
+    win_len_ = 0;
+}
+
+bool MappedFile::MapWindow(uint64_t off) {
+    Unmap();
+    uint64_t start = off & ~(kWindowAlign - 1);
+    uint64_t len = std::min(kWindowSize, size_ - start);
+    void *p = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd_, start);
+    if (p == MAP_FAILED) {
+        return false;
+    }
+    madvise(p, len, MADV_SEQUENTIAL);
+    madvise(p, len, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+    madvise(p, len, MADV_HUGEPAGE);
+#endif
+    win_ = static_cast<unsigned char *>(p);
+    win_off_ = start;
+    win_len_ = len;
+    return true;
+}
+
+const unsigned char *MappedFile::Next(size_t n) {
+    if (pos_ + n > size_) {
+        pos_ = size_;
+        return NULL;
+    }
+    if (fd_ < 0) {
+        if (buf_.size() < n) buf_.resize(n);
+        if (fread(buf_.data(), 1, n, fp_) != n) {
+            pos_ = size_;
+            return NULL;
+        }
+        pos_ += n;
+        return buf_.data();
+    }
+    // a record may straddle two windows, remap so that it is contiguous
+    if (pos_ < win_off_ || pos_ + n > win_off_ + win_len_) {
+        if (!MapWindow(pos_)) {
+            return NULL;
+        }
+    }
+    const unsigned char *p = win_ + (pos_ - win_off_);
+    pos_ += n;
+    return p;
+}
+
+size_t MappedFile::Read(void *dst, size_t n) {
+    size_t len = std::min<uint64_t>(n, size_ - pos_);
+    if (len == 0) {
+        return 0;
+    }
+    if (fd_ < 0) {
+        len = fread(dst, 1, len, fp_);
+        pos_ += len;
+        return len;
+    }
+    const unsigned char *p = Next(len);
+    if (p == NULL) {
+        return 0;
+    }
+    memcpy(dst, p, len);
+    return len;
+}
+
+bool MappedFile::Seek(uint64_t off) {
+    if (off > size_) {
+        return false;
+    }
+    if (fd_ < 0 && fp_ != NULL && fseeko(fp_, off, SEEK_SET) != 0) {
+        return false;
+    }
+    pos_ = off;
+    return true;
+}
+
+}  // namespace dramsim3
@@ -0,0 +1,50 @@
+#ifndef DRAMSIM3_MAPPED_FILE_H
+#define DRAMSIM3_MAPPED_FILE_H
+#include <stdint.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <vector>
+
+namespace dramsim3 {
+
+// Sequential reader for the raw HMTT files. The file is mapped through a
+// sliding window so multi-hundred-GB traces never need more than
+// kWindowSize of address space; records are handed out as pointers into the
+// mapping. If mmap is unavailable (or disabled) it falls back to stdio.
+class MappedFile {
+   public:
+    MappedFile();
+    ~MappedFile();
+    bool Open(const char *path, bool use_mmap = true);
+    void Close();
+
+    // pointer to the next n bytes, NULL if fewer than n bytes are left
+    const unsigned char *Next(size_t n);
+    // fread-like copy, returns the number of bytes actually read
+    size_t Read(void *dst, size_t n);
+    bool Seek(uint64_t off);
+    uint64_t Tell() const { return pos_; }
+    uint64_t Size() const { return size_; }
+    bool IsOpen() const { return fd_ >= 0 || fp_ != NULL; }
+    bool IsMapped() const { return fd_ >= 0; }
+
+    // windows are 2MB aligned so THP can back them when the fs allows it
+    static const uint64_t kWindowAlign = 2ULL << 20;
+    static const uint64_t kWindowSize = 1ULL << 30;
+
+   private:
+    bool MapWindow(uint64_t off);
+    void Unmap();
+
+    int fd_;
+    FILE *fp_;
+    uint64_t size_;
+    uint64_t pos_;
+    unsigned char *win_;
+    uint64_t win_off_;
+    uint64_t win_len_;
+    std::vector<unsigned char> buf_;
+};
+
+}  // namespace dramsim3
+#endif  // DRAMSIM3_MAPPED_FILE_H
@@ -26,6 +26,14 @@ MemorySystem::~MemorySystem() {
 
 void MemorySystem::ClockTick() { dram_system_->ClockTick(); }
 
+uint64_t MemorySystem::GetClk() const { return dram_system_->GetClk(); }
+
+uint64_t MemorySystem::NextEventCycle() const {
+    return dram_system_->NextEventCycle();
+}
+
+void MemorySystem::FastForward(uint64_t clk) { dram_system_->FastForward(clk); }
+
 double MemorySystem::GetTCK() const { return config_->tCK; }
 
 int MemorySystem::GetBusBits() const { return config_->bus_width; }
@@ -64,6 +72,33 @@ void MemorySystem::WarmUp(uint64_t hex_addr, bool is_write) {
         dynamic_cast<cadcache*>(dram_system_)->WarmUp(hex_addr, is_write);
     }
 }
+
+bool MemorySystem::HasCache() const {
+    return config_->protocol == DRAMProtocol::MEMPOOL;
+}
+
+void MemorySystem::SaveState(StateWriter &w) const {
+    if (HasCache()){
+        dynamic_cast<cadcache*>(dram_system_)->SaveState(w);
+    }
+}
+
+bool MemorySystem::LoadState(StateReader &r) {
+    if (HasCache()){
+        return dynamic_cast<cadcache*>(dram_system_)->LoadState(r);
+    }
+    return false;
+}
+
+bool MemorySystem::GetCacheStat(uint64_t &hit, uint64_t &miss) const {
+    if (config_->protocol == DRAMProtocol::MEMPOOL){
+        dynamic_cast<cadcache*>(dram_system_)->GetCacheStat(hit, miss);
+        return true;
+    }
+    hit = 0;
+    miss = 0;
+    return false;
+}
 }  // namespace dramsim3
 
 // This function can be used by autoconf AC_CHECK_LIB since
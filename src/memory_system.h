@@ -19,6 +19,10 @@ class MemorySystem {
                  std::function<void(uint64_t)> write_callback);
     ~MemorySystem();
     void ClockTick();
+    // skipping idle cycles, see BaseDRAMSystem::NextEventCycle
+    uint64_t GetClk() const;
+    uint64_t NextEventCycle() const;
+    void FastForward(uint64_t clk);
     void RegisterCallbacks(std::function<void(uint64_t)> read_callback,
                            std::function<void(uint64_t)> write_callback);
     double GetTCK() const;
@@ -31,6 +35,12 @@ class MemorySystem {
     bool WillAcceptTransaction(uint64_t hex_addr, bool is_write) const;
     bool AddTransaction(uint64_t hex_addr, bool is_write);
     void WarmUp(uint64_t hex_addr, bool is_write);
+    // warmed state of the DRAM cache, false if the protocol has no cache
+    bool HasCache() const;
+    void SaveState(StateWriter &w) const;
+    bool LoadState(StateReader &r);
+    // hit/miss of the DRAM cache, false if the protocol has no cache
+    bool GetCacheStat(uint64_t &hit, uint64_t &miss) const;
 
    private:
     // These have to be pointers because Gem5 will try to push this object
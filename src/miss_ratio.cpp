@@ -0,0 +1,121 @@
+#include "miss_ratio.h"
+#include <math.h>
+#include <algorithm>
+#include <utility>
+
+namespace dramsim3 {
+
+const uint64_t StackDistance::kHashBits;
+
+namespace {
+
+const uint64_t kInitialTimes = 1 << 20;
+
+}  // namespace
+
+StackDistance::StackDistance(uint64_t block_size, double rate)
+    : block_size_(block_size),
+      rate_(rate),
+      threshold_(static_cast<uint64_t>(rate * (1ULL << kHashBits))),
+      accesses_(0),
+      sampled_(0),
+      cold_(0),
+      now_(0),
+      tree_(kInitialTimes + 1, 0) {}
+
+void StackDistance::Access(uint64_t addr) {
+    accesses_++;
+    uint64_t block = addr / block_size_;
+    if ((HashPage(block) & ((1ULL << kHashBits) - 1)) >= threshold_) {
+        return;
+    }
+    sampled_++;
+    if (now_ + 1 >= tree_.size()) {
+        Compact();
+    }
+
+    uint64_t last = last_use_.Get(block);
+    if (last == 0) {
+        cold_++;
+    } else {
+        uint64_t t = last - 1;
+        uint64_t d = Prefix(now_) - Prefix(t + 1);
+        if (d >= histo_.size()) {
+            histo_.resize(std::max<uint64_t>(d + 1, histo_.size() * 2), 0);
+        }
+        histo_[d]++;
+        Mark(t, -1);
+    }
+    Mark(now_, 1);
+    last_use_.Set(block, now_ + 1);
+    now_++;
+}
+
+void StackDistance::Mark(uint64_t t, int64_t v) {
+    for (uint64_t i = t + 1; i < tree_.size(); i += i & (~i + 1)) {
+        tree_[i] += v;
+    }
+}
+
+uint64_t StackDistance::Prefix(uint64_t t) const {
+    int64_t sum = 0;
+    for (uint64_t i = t; i > 0; i -= i & (~i + 1)) {
+        sum += tree_[i];
+    }
+    return sum;
+}
+
+// renumber the last uses of live blocks 0..n-1, keeping their order
+void StackDistance::Compact() {
+    std::vector<std::pair<uint64_t, uint64_t>> live;
+    live.reserve(last_use_.Size());
+    last_use_.ForEach([&live](uint64_t block, uint64_t t) {
+        live.push_back(std::make_pair(t, block));
+    });
+    std::sort(live.begin(), live.end());
+
+    uint64_t times = tree_.size() - 1;
+    while (live.size() * 2 > times) {
+        times *= 2;
+    }
+    tree_.assign(times + 1, 0);
+    for (uint64_t i = 0; i < live.size(); i++) {
+        last_use_.Set(live[i].second, i + 1);
+        Mark(i, 1);
+    }
+    now_ = live.size();
+}
+
+double StackDistance::MissRatio(uint64_t lines, uint64_t ways) const {
+    if (sampled_ == 0) {
+        return 0;
+    }
+    uint64_t sets = 1;
+    if (ways == 0 || ways >= lines) {
+        ways = lines;
+    } else {
+        sets = lines / ways;
+    }
+
+    double hits = 0;
+    double p = 1.0 / sets;
+    for (uint64_t d = 0; d < histo_.size(); d++) {
+        if (histo_[d] == 0) continue;
+        double x = d / rate_;
+        if (sets == 1) {
+            hits += x < ways ? histo_[d] : 0;
+            continue;
+        }
+        // P(fewer than `ways` of x blocks fall into one of `sets` sets)
+        double term = exp(x * log1p(-p));
+        double hit = term;
+        for (uint64_t k = 0; k + 1 < ways && x > k; k++) {
+            term *= (x - k) / (k + 1) * p / (1 - p);
+            hit += term;
+        }
+        hits += histo_[d] * std::min(hit, 1.0);
+    }
+    return 1 - hits / sampled_;
+}
+
+}  // namespace dramsim3
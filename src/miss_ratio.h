@@ -0,0 +1,53 @@
+#ifndef DRAMSIM3_MISS_RATIO_H
+#define DRAMSIM3_MISS_RATIO_H
+#include <stdint.h>
+#include <vector>
+#include "page_table.h"
+
+namespace dramsim3 {
+
+// LRU stack distance histogram of one block size, sampled SHARDS-style:
+// a block is tracked only if hash(block) falls below rate * 2^24, and the
+// distances of tracked blocks are scaled by 1 / rate. Distances are counted
+// with a Fenwick tree over access times, which is compacted to the live
+// blocks when it fills up.
+class StackDistance {
+   public:
+    StackDistance(uint64_t block_size, double rate);
+    void Access(uint64_t addr);
+
+    // predicted miss ratio of a cache of `lines` blocks with `ways` ways per
+    // set; ways == 0 is fully associative LRU. Set-associative caches use
+    // the binomial model: an access hits if fewer than `ways` of the blocks
+    // touched since its last use map to its set, assuming random placement.
+    double MissRatio(uint64_t lines, uint64_t ways) const;
+
+    uint64_t BlockSize() const { return block_size_; }
+    double Rate() const { return rate_; }
+    uint64_t Accesses() const { return accesses_; }
+    uint64_t Sampled() const { return sampled_; }
+    uint64_t Cold() const { return cold_; }
+    // distinct blocks, scaled to the whole trace
+    uint64_t Blocks() const { return last_use_.Size() / rate_; }
+
+    static const uint64_t kHashBits = 24;
+
+   private:
+    void Mark(uint64_t t, int64_t v);
+    uint64_t Prefix(uint64_t t) const;  // marks in [0, t)
+    void Compact();
+
+    const uint64_t block_size_;
+    const double rate_;
+    const uint64_t threshold_;
+    uint64_t accesses_;
+    uint64_t sampled_;
+    uint64_t cold_;
+    uint64_t now_;
+    PageHashMap last_use_;  // block -> access time + 1
+    std::vector<int32_t> tree_;
+    std::vector<uint64_t> histo_;  // unscaled distance -> sampled accesses
+};
+
+}  // namespace dramsim3
+#endif  // DRAMSIM3_MISS_RATIO_H
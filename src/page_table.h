@@ -0,0 +1,150 @@
+#ifndef DRAMSIM3_PAGE_TABLE_H
+#define DRAMSIM3_PAGE_TABLE_H
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+namespace dramsim3 {
+
+// well-mixed 64-bit hash of a page or block number (splitmix64 finalizer)
+inline uint64_t HashPage(uint64_t key) {
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return key;
+}
+
+// Two-level radix table over keys [0, size). Leaves of 2^kLeafBits entries
+// are allocated on the first non-zero write, untouched keys read as 0.
+template <typename T, int kLeafBits = 12>
+class RadixTable {
+   public:
+    explicit RadixTable(uint64_t size)
+        : size_(size), leaves_((size + kLeafMask) >> kLeafBits) {}
+
+    T Get(uint64_t key) const {
+        if (key >= size_) return T();
+        const T *leaf = leaves_[key >> kLeafBits].get();
+        return leaf == nullptr ? T() : leaf[key & kLeafMask];
+    }
+
+    void Set(uint64_t key, T value) {
+        if (key >= size_) return;
+        std::unique_ptr<T[]> &leaf = leaves_[key >> kLeafBits];
+        if (leaf == nullptr) {
+            if (value == T()) return;
+            leaf.reset(new T[kLeafSize]());
+            num_leaves_++;
+        }
+        leaf[key & kLeafMask] = value;
+    }
+
+    void Clear() {
+        for (auto &leaf : leaves_) leaf.reset();
+        num_leaves_ = 0;
+    }
+
+    // f(key, value) for every non-zero entry, in key order
+    template <typename F>
+    void ForEach(F f) const {
+        for (uint64_t i = 0; i < leaves_.size(); i++) {
+            const T *leaf = leaves_[i].get();
+            if (leaf == nullptr) continue;
+            for (uint64_t j = 0; j < kLeafSize; j++) {
+                if (leaf[j] != T()) f((i << kLeafBits) | j, leaf[j]);
+            }
+        }
+    }
+
+    uint64_t ResidentBytes() const {
+        return leaves_.size() * sizeof(leaves_[0]) +
+               num_leaves_ * kLeafSize * sizeof(T);
+    }
+
+   private:
+    static const uint64_t kLeafSize = 1ULL << kLeafBits;
+    static const uint64_t kLeafMask = kLeafSize - 1;
+    uint64_t size_;
+    uint64_t num_leaves_ = 0;
+    std::vector<std::unique_ptr<T[]>> leaves_;
+};
+
+// Open-addressing (linear probing) map between page numbers. Missing keys
+// read as 0, entries are never erased.
+class PageHashMap {
+   public:
+    PageHashMap() : size_(0), slots_(kMinCapacity, Slot{kEmpty, 0}) {}
+
+    uint64_t Get(uint64_t key) const {
+        if (key == kEmpty) return 0;
+        uint64_t mask = slots_.size() - 1;
+        for (uint64_t i = Hash(key) & mask;; i = (i + 1) & mask) {
+            if (slots_[i].key == key) return slots_[i].value;
+            if (slots_[i].key == kEmpty) return 0;
+        }
+    }
+
+    void Set(uint64_t key, uint64_t value) {
+        if (key == kEmpty) return;
+        if ((size_ + 1) * 2 > slots_.size()) Grow();
+        Slot &s = Find(key);
+        if (s.key == kEmpty) {
+            s.key = key;
+            size_++;
+        }
+        s.value = value;
+    }
+
+    void Clear() {
+        slots_.assign(kMinCapacity, Slot{kEmpty, 0});
+        size_ = 0;
+    }
+
+    template <typename F>
+    void ForEach(F f) const {
+        for (const Slot &s : slots_) {
+            if (s.key != kEmpty) f(s.key, s.value);
+        }
+    }
+
+    uint64_t Size() const { return size_; }
+    uint64_t ResidentBytes() const { return slots_.size() * sizeof(Slot); }
+
+   private:
+    struct Slot {
+        uint64_t key;
+        uint64_t value;
+    };
+    static const uint64_t kEmpty = ~0ULL;
+    static const uint64_t kMinCapacity = 1024;
+
+    static uint64_t Hash(uint64_t key) {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        return key;
+    }
+
+    Slot &Find(uint64_t key) {
+        uint64_t mask = slots_.size() - 1;
+        for (uint64_t i = Hash(key) & mask;; i = (i + 1) & mask) {
+            if (slots_[i].key == key || slots_[i].key == kEmpty) return slots_[i];
+        }
+    }
+
+    void Grow() {
+        std::vector<Slot> old(slots_.size() * 2, Slot{kEmpty, 0});
+        old.swap(slots_);
+        for (const Slot &s : old) {
+            if (s.key != kEmpty) Find(s.key) = s;
+        }
+    }
+
+    uint64_t size_;
+    std::vector<Slot> slots_;
+};
+
+}  // namespace dramsim3
+#endif  // DRAMSIM3_PAGE_TABLE_H
@@ -0,0 +1,120 @@
+#include "pending_table.h"
+
+namespace dramsim3 {
+
+PendingTable::PendingTable(size_t capacity)
+    : used_(0), size_(0), free_(kNone) {
+    size_t n = 16;
+    shift_ = 60;
+    // at most half full
+    while (n < capacity * 2) {
+        n <<= 1;
+        shift_--;
+    }
+    slots_.assign(n, Slot{0, 0, kNone, kNone});
+    mask_ = n - 1;
+    nodes_.reserve(capacity);
+}
+
+size_t PendingTable::Home(uint64_t addr) const {
+    // Fibonacci hashing, the low address bits are mostly equal
+    return static_cast<size_t>((addr * 0x9E3779B97F4A7C15ULL) >> shift_);
+}
+
+size_t PendingTable::Find(uint64_t addr) const {
+    size_t i = Home(addr);
+    while (slots_[i].count != 0 && slots_[i].addr != addr) {
+        i = (i + 1) & mask_;
+    }
+    return i;
+}
+
+size_t PendingTable::Count(uint64_t addr) const {
+    return slots_[Find(addr)].count;
+}
+
+const Transaction *PendingTable::Front(uint64_t addr) const {
+    const Slot &slot = slots_[Find(addr)];
+    return slot.count == 0 ? nullptr : &nodes_[slot.head].trans;
+}
+
+uint32_t PendingTable::NewNode(const Transaction &trans) {
+    uint32_t n = free_;
+    if (n != kNone) {
+        free_ = nodes_[n].next;
+        nodes_[n].trans = trans;
+        nodes_[n].next = kNone;
+    } else {
+        n = static_cast<uint32_t>(nodes_.size());
+        nodes_.push_back(Node{trans, kNone});
+    }
+    return n;
+}
+
+void PendingTable::Push(const Transaction &trans) {
+    if ((used_ + 1) * 2 > slots_.size()) {
+        Grow();
+    }
+    uint32_t n = NewNode(trans);
+    Slot &slot = slots_[Find(trans.addr)];
+    if (slot.count == 0) {
+        slot = Slot{trans.addr, 1, n, n};
+        used_++;
+    } else {
+        nodes_[slot.tail].next = n;
+        slot.tail = n;
+        slot.count++;
+    }
+    size_++;
+}
+
+bool PendingTable::Pop(uint64_t addr, Transaction &trans) {
+    size_t i = Find(addr);
+    Slot &slot = slots_[i];
+    if (slot.count == 0) {
+        return false;
+    }
+    uint32_t n = slot.head;
+    trans = nodes_[n].trans;
+    slot.head = nodes_[n].next;
+    nodes_[n].next = free_;
+    free_ = n;
+    size_--;
+    if (--slot.count == 0) {
+        Erase(i);
+    }
+    return true;
+}
+
+void PendingTable::Erase(size_t slot) {
+    // backward shift: pull later entries of the probe run into the hole so
+    // lookups never need tombstones
+    size_t hole = slot;
+    size_t i = (hole + 1) & mask_;
+    while (slots_[i].count != 0) {
+        size_t home = Home(slots_[i].addr);
+        // the entry may move to the hole if its home is not in (hole, i]
+        if (((i - home) & mask_) >= ((i - hole) & mask_)) {
+            slots_[hole] = slots_[i];
+            hole = i;
+        }
+        i = (i + 1) & mask_;
+    }
+    slots_[hole] = Slot{0, 0, kNone, kNone};
+    used_--;
+}
+
+void PendingTable::Grow() {
+    std::vector<Slot> old;
+    old.swap(slots_);
+    slots_.assign(old.size() * 2, Slot{0, 0, kNone, kNone});
+    mask_ = slots_.size() - 1;
+    shift_--;
+    for (auto &slot : old) {
+        if (slot.count != 0) {
+            slots_[Find(slot.addr)] = slot;
+        }
+    }
+}
+
+}  // namespace dramsim3
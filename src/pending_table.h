@@ -0,0 +1,57 @@
+#ifndef DRAMSIM3_PENDING_TABLE_H
+#define DRAMSIM3_PENDING_TABLE_H
+#include <stdint.h>
+#include <vector>
+#include "common.h"
+
+namespace dramsim3 {
+
+// Transactions of a controller waiting for their command, by address.
+// Addresses live in an open-addressing (linear probing) table, the
+// transactions of an address form a FIFO list of nodes taken from a pool
+// that is reused, so steady state inserts and removals do not allocate.
+class PendingTable {
+   public:
+    explicit PendingTable(size_t capacity = 64);
+    size_t Count(uint64_t addr) const;
+    bool Empty() const { return size_ == 0; }
+    // appended behind the transactions of the same address
+    void Push(const Transaction &trans);
+    // the oldest transaction of `addr`, nullptr if there is none
+    const Transaction *Front(uint64_t addr) const;
+    // removes the oldest transaction of `addr` into `trans`
+    bool Pop(uint64_t addr, Transaction &trans);
+
+   private:
+    static const uint32_t kNone = UINT32_MAX;
+    struct Slot {
+        uint64_t addr;
+        uint32_t count;
+        uint32_t head;
+        uint32_t tail;
+    };
+    struct Node {
+        Transaction trans;
+        uint32_t next;
+    };
+
+    size_t Home(uint64_t addr) const;
+    // the slot holding `addr`, or the empty slot it would go to
+    size_t Find(uint64_t addr) const;
+    void Erase(size_t slot);
+    void Grow();
+    uint32_t NewNode(const Transaction &trans);
+
+    std::vector<Slot> slots_;
+    size_t mask_;
+    int shift_;
+    // addresses in the table
+    size_t used_;
+    // transactions in the table
+    size_t size_;
+    std::vector<Node> nodes_;
+    uint32_t free_;
+};
+
+}  // namespace dramsim3
+#endif  // DRAMSIM3_PENDING_TABLE_H
@@ -18,9 +18,6 @@ CacheFrontEnd::CacheFrontEnd(std::string output_dir, JedecDRAMSystem *cache, Con
     for (int i = 0; i <= (4096/256); ++i) {
         line_utility[i] = 0;
     }
-    for (int i = 0; i <= 64; ++i) {
-        mshr_waiting[i] = 0;
-    }
 }
 
 bool CacheFrontEnd::hit_and_return(Tag &tag_, uint64_t hex_addr, bool is_write){
@@ -128,6 +125,12 @@ void CacheFrontEnd::Drained() {
     ProcessRefillReq();
 }
 
+uint64_t CacheFrontEnd::NextEventCycle() const {
+    if(!refill_req_to_cache.empty())
+        return GetCLK();
+    return FrontEnd::NextEventCycle();
+}
+
 void CacheFrontEnd::CacheReadCallBack(uint64_t req_id) {
     //check pending_req_to_cache first in case the refill request coming right after
     //the read req sent to $DRAM
@@ -214,7 +217,7 @@ void CacheFrontEnd::DoRefill(uint64_t req_id, Tag &t, uint64_t hex_addr_cache, u
         }
     }
 
-    mshr_waiting[reqs.size()] ++;
+    mshr_waiting.Add(reqs.size());
     // update tags
     // response data
     //std::cout<<reqs.size()<<" wait in MSHR\n";
@@ -256,8 +259,14 @@ void CacheFrontEnd::PrintStat() {
         utilization_file<<i->first<<" "<<i->second<<"\n";
     }
     std::cout<<"# waiting reqs in MSHR\n";
-    for (auto i = mshr_waiting.begin(); i != mshr_waiting.end(); ++i) {
-        std::cout<<i->first<<" "<<i->second<<"\n";
+    mshr_waiting.ForEach([](uint64_t low, uint64_t high, uint64_t count) {
+        std::cout<<low;
+        if(high != low)
+            std::cout<<"-"<<high;
+        std::cout<<" "<<count<<"\n";
+    });
+    for (auto &i : mshr_waiting.Summary()) {
+        std::cout<<"# "<<i.first<<" "<<i.second<<"\n";
     }
 }
 
@@ -269,8 +278,6 @@ void CacheFrontEnd::ResetStat() {
     for (int i = 0; i <= (4096/256); ++i) {
         line_utility[i] = 0;
     }
-    for (int i = 0; i <= 64; ++i) {
-        mshr_waiting[i] = 0;
-    }
+    mshr_waiting.Clear();
 }
 }
\ No newline at end of file
@@ -24,7 +24,7 @@ private:
     uint64_t miss;
     uint64_t refill_times;
     SimpleStats::HistoCount line_utility;
-    SimpleStats::HistoCount mshr_waiting;
+    LogHistogram mshr_waiting;
     bool miss_and_return();
     bool hit_and_return(Tag &tag_, uint64_t hex_addr, bool is_write);
 
@@ -59,6 +59,9 @@ public:
     void WarmUp(uint64_t hex_addr, bool is_write) override;
     void PrintStat() override;
     void ResetStat() override;
+    //hits in the write back buffer count as hits
+    uint64_t NextEventCycle() const override;
+    void GetStat(uint64_t &hit_, uint64_t &miss_) const override { hit_ = hit + wb_hit; miss_ = miss; };
 };
 
 }
@@ -90,6 +90,12 @@ void Kona::HashReadCallBack(uint64_t req_id) {
     AbruptExit(__FILE__, __LINE__);
 }
 
+uint64_t Kona::NextEventCycle() const {
+    if(!pending_req_to_hashmap.empty())
+        return GetCLK();
+    return CacheFrontEnd::NextEventCycle();
+}
+
 void Kona::Drained() {
     CacheFrontEnd::Drained();
 
@@ -29,6 +29,7 @@ class Kona : public CacheFrontEnd{
     Kona(std::string output_dir, JedecDRAMSystem *cache, Config &config);
     ~Kona(){};
     void Drained() override;
+    uint64_t NextEventCycle() const override;
 };
 }
 #endif //DRAMSIM3_KONA_H
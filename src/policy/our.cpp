@@ -7,9 +7,9 @@
 namespace dramsim3{
 
 SRAMCache::SRAMCache(uint64_t hex_base, JedecDRAMSystem *dram_, uint64_t sz, uint64_t capacity,
-                            std::vector<PTentry> *data_backup_)
+                            std::vector<PTentry> *data_backup_, RandomState *rng_)
     : hex_dram_base_addr(hex_base), dType_sz(sz),
-    assoc(64 / sz), data_backup(data_backup_), dram(dram_){
+    assoc(64 / sz), data_backup(data_backup_), dram(dram_), rng(rng_){
     data.resize(capacity / sz / assoc);
     for (int i = 0; i < data.size(); ++i) {
         data[i].resize(assoc);
@@ -123,7 +123,7 @@ PTentry SRAMCache::GetData(uint64_t hex_offset, uint64_t &offset) {
             return data[index][i];
         }
     }
-    offset = rand() % assoc;
+    offset = rng->Next() % assoc;
     return data[index][offset];
 }
 
@@ -173,16 +173,35 @@ std::vector<PTentry> SRAMCache::WarmUpRead(uint64_t hex_offset) {
     return data[index];
 }
 
+void SRAMCache::SaveState(StateWriter &w) const {
+    w.Put<uint64_t>(data.size());
+    for (auto &g : data) {
+        w.Put(g);
+    }
+    Tag::SaveAll(w, tags);
+}
+
+bool SRAMCache::LoadState(StateReader &r) {
+    uint64_t n = 0;
+    if(!r.Get(n) || n != data.size())
+        return false;
+    for (auto &g : data) {
+        if(!r.Get(g) || g.size() != assoc)
+            return false;
+    }
+    return Tag::LoadAll(r, tags);
+}
+
 our::our(std::string output_dir, JedecDRAMSystem *cache, Config &config):
     CacheFrontEnd(output_dir, cache, config),
     hashmap_hex_addr(Meta_SRAM.size()*4096),
     pte_size(16),
     hpt_sz_ratio(config.hpt_ratio),
     mwl(config.mwl),
-    tlb(hashmap_hex_addr, cache, pte_size, 64 * 1024, &hash_page_table),
+    tlb(hashmap_hex_addr, cache, pte_size, 64 * 1024, &hash_page_table, &rng),
     rtlb(hashmap_hex_addr + Meta_SRAM.size() * hpt_sz_ratio * pte_size, cache, 8, Meta_SRAM.size(), &pte_addr_table),
     hashmap_hex_addr_block_region(hashmap_hex_addr + Meta_SRAM.size() * hpt_sz_ratio * pte_size + Meta_SRAM.size() * 8),
-    tlb_block_region(hashmap_hex_addr_block_region, cache, pte_size, 1 * 1024 * 1024, &hpt_block_region),
+    tlb_block_region(hashmap_hex_addr_block_region, cache, pte_size, 1 * 1024 * 1024, &hpt_block_region, &rng),
     rtlb_block_region(hashmap_hex_addr_block_region + Meta_SRAM.size() * 16 * hpt_sz_ratio * pte_size, cache, 8,
                       Meta_SRAM.size() * 16, &rpt_block_region){
     std::cout<<"our frontend\n";
@@ -192,13 +211,11 @@ our::our(std::string output_dir, JedecDRAMSystem *cache, Config &config):
         std::cerr << "utilization file does not exist" << std::endl;
         AbruptExit(__FILE__, __LINE__);
     }
-    searching_file.open(output_dir+"/searching_"+name_suffix);
-    if (searching_file.fail()) {
+    if (!searching_file.Open(output_dir+"/searching_"+name_suffix)) {
         std::cerr << "utilization file does not exist" << std::endl;
         AbruptExit(__FILE__, __LINE__);
     }
-    capacity_file.open(output_dir+"/capacity_"+name_suffix);
-    if (capacity_file.fail()) {
+    if (!capacity_file.Open(output_dir+"/capacity_"+name_suffix)) {
         std::cerr << "capacity file does not exist" << std::endl;
         AbruptExit(__FILE__, __LINE__);
     }
@@ -430,7 +447,7 @@ void our::Refill(uint64_t req_id) {
             }
 
             pending_req_to_PT.emplace_back(intermediate_data(MSHRs[req_id].pt_index % hash_page_table.size(), req_id));
-            Sample(miss_penalty, GetCLK() - MSHRs[req_id].send_time[req_id]);
+            miss_penalty.Add(GetCLK() - MSHRs[req_id].send_time[req_id]);
             MSHRs.erase(req_id);
         }else{
             pending_req_to_PT_br.emplace_back(intermediate_data(MSHRs[hex_addr_page].pt_index % hpt_block_region.size(),
@@ -443,7 +460,7 @@ void our::Refill(uint64_t req_id) {
             }
             MSHRs[hex_addr_page].blocks.erase(req_id);
             MSHRs[hex_addr_page].adjacent_blocks ++;
-            Sample(miss_penalty, GetCLK() - MSHRs[hex_addr_page].send_time[req_id]);
+            miss_penalty.Add(GetCLK() - MSHRs[hex_addr_page].send_time[req_id]);
             if(MSHRs[hex_addr_page].blocks.size() == 0)
                 MSHRs.erase(hex_addr_page);
         }
@@ -498,6 +515,18 @@ void our::ProceedToNextFree(bool is_page_region) {
     }
 }
 
+uint64_t our::NextEventCycle() const {
+    uint64_t clk = GetCLK();
+    if(!(tlb.Idle() && rtlb.Idle() && tlb_block_region.Idle() && rtlb_block_region.Idle()) ||
+       !pending_req_to_PT.empty() || !pending_req_to_PT_br.empty() ||
+       !fetch_engine_q.empty() || !send_page_q.empty() ||
+       !pending_req_to_Meta.empty() || !front_q_br.empty())
+        return clk;
+    //Drained() runs after the cache clock ticks, it sees clk + 1
+    uint64_t next = ((clk + 1 + mwl - 1) / mwl) * mwl - 1;
+    return std::min(next, CacheFrontEnd::NextEventCycle());
+}
+
 void our::Drained() {
     tlb.Drained();
     rtlb.Drained();
@@ -506,12 +535,14 @@ void our::Drained() {
 
     if(GetCLK() % mwl == 0){
         double miss_rate = 1.0 * miss_in_both / (hit_in_pr + hit_in_br + miss_in_both);
-        double avg_miss_penalty = miss_rate * SimpleStats::GetHistoAvg(miss_penalty);
+        double avg_miss_penalty = miss_rate * miss_penalty.Mean();
         std::cout<<"hit in block region "<<hit_in_br<<" "<<1.0*hit_in_br / (hit_in_br + miss_in_both)<<"\n"
                     <<"hit in page region "<<hit_in_pr<<" "<<1.0*hit_in_pr / (hit_in_pr + miss_in_both)<<"\n"
                     <<"miss in both "<<miss_in_both<<"\n"
                     <<"miss rate: "<<miss_rate<<"\n"
-                    <<"miss penalty: "<<avg_miss_penalty<<"\n";
+                    <<"miss penalty: "<<avg_miss_penalty<<"\n"
+                    <<"miss latency p50/p99/max: "<<miss_penalty.Percentile(50)<<" "
+                    <<miss_penalty.Percentile(99)<<" "<<miss_penalty.Max()<<"\n";
 
         std::vector<uint64_t> partial_sum(4, 0);
         partial_sum[0] = line_utility_partial[1] + line_utility_partial[2];
@@ -554,7 +585,7 @@ void our::Drained() {
                 //    break;
                 //}
 
-                uint64_t option = rand() % 5;
+                uint64_t option = rng.Next() % 5;
                 if(option == 0 && enable_roll_back){
                     roll_back = true;
                     break;
@@ -625,7 +656,7 @@ void our::Drained() {
                 padding_interval.clear();
                 padding_to_page = 0;
                 promotion_to_page = 0;
-                miss_penalty.clear();
+                miss_penalty.Clear();
             }
 
             if(try_last_state){
@@ -1027,12 +1058,12 @@ void our::WarmUp(uint64_t hex_addr, bool is_write) {
         }
 
         data_.to_page_region = true;
-        data_.offset = rand() % e.size();
+        data_.offset = rng.Next() % e.size();
         data_.pte = e[data_.offset];
         data_.pt_index = pt_index;
     }else{
         data_.to_page_region = false;
-        data_.offset = rand() % e_br.size();
+        data_.offset = rng.Next() % e_br.size();
         data_.pte = e_br[data_.offset];
         data_.pt_index = pt_index_br;
     }
@@ -1041,6 +1072,50 @@ void our::WarmUp(uint64_t hex_addr, bool is_write) {
     RefillToRegionWarmUp(data_, is_write);
 }
 
+void our::SaveState(StateWriter &w) const {
+    CacheFrontEnd::SaveState(w);
+    Tag::SaveAll(w, meta_block_region);
+    auto valid_pte = [](const PTentry &e) { return e.valid; };
+    auto valid_rpte = [](const RPTentry &e) { return e.valid; };
+    w.PutSparse(hash_page_table, valid_pte);
+    w.PutSparse(hpt_block_region, valid_pte);
+    w.PutSparse(pte_addr_table, valid_rpte);
+    w.PutSparse(rpt_block_region, valid_rpte);
+    tlb.SaveState(w);
+    tlb_block_region.SaveState(w);
+    rtlb.SaveState(w);
+    rtlb_block_region.SaveState(w);
+    w.Put(v_hex_addr_cache);
+    w.Put(v_hex_addr_cache_br);
+    w.Put(PROMOTION_T);
+    w.Put(PADDING_T);
+    w.Put(roll_back_times);
+    w.Put(idole_time);
+    w.Put(last_status);
+    rng.Save(w);
+}
+
+bool our::LoadState(StateReader &r) {
+    if(!CacheFrontEnd::LoadState(r))
+        return false;
+    if(!Tag::LoadAll(r, meta_block_region))
+        return false;
+    if(!r.GetSparse(hash_page_table, PTentry()) || !r.GetSparse(hpt_block_region, PTentry()) ||
+       !r.GetSparse(pte_addr_table, RPTentry()) || !r.GetSparse(rpt_block_region, RPTentry()))
+        return false;
+    if(!tlb.LoadState(r) || !tlb_block_region.LoadState(r) ||
+       !rtlb.LoadState(r) || !rtlb_block_region.LoadState(r))
+        return false;
+    r.Get(v_hex_addr_cache);
+    r.Get(v_hex_addr_cache_br);
+    r.Get(PROMOTION_T);
+    r.Get(PADDING_T);
+    r.Get(roll_back_times);
+    r.Get(idole_time);
+    r.Get(last_status);
+    return rng.Load(r);
+}
+
 void our::PrintStat() {
 
     utilization_file<<"# hashmap collision time: "<<collision_times<<"\n"
@@ -5,11 +5,51 @@
 #ifndef DRAMSIM3_OUR_H
 #define DRAMSIM3_OUR_H
 #include "cache_frontend.h"
+#include "../stats_sink.h"
 #include "../../util/murmur3/murmur3.h"
 
 //#define PROMOTION_T 2
 
 namespace dramsim3 {
+/*
+ * per-instance copy of glibc's rand() (TYPE_3 additive feedback),
+ * seeded the same way as srand(), so that caches simulated on
+ * separate threads do not share one random sequence
+ * */
+class RandomState{
+    private:
+    uint32_t r[34];
+    int i;
+    public:
+    RandomState(uint32_t seed = 1){
+        int32_t word = seed == 0 ? 1 : seed;
+        r[0] = word;
+        for (int j = 1; j < 31; ++j) {
+            //16807 * word % 2147483647 without overflow
+            int32_t hi = word / 127773, lo = word % 127773;
+            word = 16807 * lo - 2836 * hi;
+            if(word < 0) word += 2147483647;
+            r[j] = word;
+        }
+        for (int j = 31; j < 34; ++j) {
+            r[j] = r[j - 31];
+        }
+        i = 0;
+        for (int j = 34; j < 344; ++j) {
+            Next();
+        }
+    };
+    int Next(){
+        //r[n] = r[n-31] + r[n-3], kept in a ring of 34
+        uint32_t v = r[(i + 3) % 34] + r[(i + 31) % 34];
+        r[i] = v;
+        i = (i + 1) % 34;
+        return v >> 1;
+    };
+    void Save(StateWriter &w) const { w.Put(r); w.Put(i); };
+    bool Load(StateReader &r_) { r_.Get(r); return r_.Get(i); };
+};
+
 class PTentry{
     public:
     uint64_t hex_addr_aligned;
@@ -48,6 +88,7 @@ class SRAMCache{
     std::vector<PTentry> *data_backup;
     std::vector<Tag> tags;
     JedecDRAMSystem *dram;
+    RandomState *rng;
     //std::function<void(uint64_t req_id)> read_callback_;
     std::list<std::pair<CacheAddr, bool>> pending_req_to_dram;
     std::unordered_map<CacheAddr, uint64_t> waiting_resp_from_dram;
@@ -60,12 +101,13 @@ class SRAMCache{
     uint64_t last_hit_req;
   public:
     SRAMCache(uint64_t hex_base, JedecDRAMSystem *dram_, uint64_t sz, uint64_t capacity,
-              std::vector<PTentry> *data_backup_);
+              std::vector<PTentry> *data_backup_, RandomState *rng_);
     //SRAMCache(){};
     ~SRAMCache(){};
     //hit return true
     bool AddTransaction(uint64_t hex_offset, bool is_write, uint64_t offset = 0, PTentry dptr = PTentry());
     void Drained();
+    bool Idle() const { return pending_req_to_dram.empty(); };
     bool DRAMReadBack(CacheAddr req_id);
     //return a free pte or randomly chosen one from pte group
     PTentry GetData(uint64_t hex_offset, uint64_t &offset);
@@ -75,6 +117,9 @@ class SRAMCache{
     std::vector<PTentry> GetDataGroup(uint64_t hex_offset);
     std::vector<PTentry> WarmUpRead(uint64_t hex_offset);
     void WarmUPWrite(uint64_t hex_offset, uint64_t offset, PTentry dptr);
+    //cached groups and tags, the backing table is saved by its owner
+    void SaveState(StateWriter &w) const;
+    bool LoadState(StateReader &r);
 };
 
 /*
@@ -107,9 +152,12 @@ class RPTCache {
     void AddTransaction(uint64_t hex_offset, bool is_write, RPTentry dptr = RPTentry());
     bool WillAcceptTransaction();
     void Drained();
+    bool Idle() const { return pending_req_to_RPT.empty(); };
     bool DRAMReadBack(CacheAddr req_id);
     RPTentry GetData(uint64_t hex_offset);
     RPTentry WarmUp(uint64_t hex_offset, bool is_write, RPTentry dptr = RPTentry());
+    void SaveState(StateWriter &w) const { w.Put(tag); };
+    bool LoadState(StateReader &r) { return r.Get(tag); };
 };
 
 class our : public CacheFrontEnd{
@@ -119,6 +167,7 @@ class our : public CacheFrontEnd{
     const uint32_t pte_size;
     const double hpt_sz_ratio;
     const uint32_t mwl;
+    RandomState rng;
     class intermediate_data{
         public:
         uint32_t rpt_index;
@@ -150,8 +199,8 @@ class our : public CacheFrontEnd{
         hex_addr(hex_addr_), is_write(is_write_),pt_index_br(pt_index_br_){};
         intermediate_req(){};
     };
-    std::ofstream searching_file;
-    std::ofstream capacity_file;
+    StatsSink searching_file;
+    StatsSink capacity_file;
     std::vector<PTentry> hash_page_table;
     SRAMCache tlb;
     std::vector<RPTentry> pte_addr_table;
@@ -234,11 +283,12 @@ class our : public CacheFrontEnd{
         threshold(uint64_t PROMOTION_T_, uint64_t PADDING_T_, double miss_rate_, uint64_t roll_back_times_):
         PROMOTION_T(PROMOTION_T_), PADDING_T(PADDING_T_), miss_rate(miss_rate_),
         roll_back_times(roll_back_times_){};
+        threshold(){};
     };
     std::list<threshold> last_status;
     SimpleStats::HistoCount line_utility_partial;
     SimpleStats::HistoCount padding_interval;
-    SimpleStats::HistoCount miss_penalty;
+    LogHistogram miss_penalty;
     void Sample(SimpleStats::HistoCount &hist, uint64_t key);
 
   protected:
@@ -253,13 +303,16 @@ class our : public CacheFrontEnd{
   public:
     our(std::string output_dir, JedecDRAMSystem *cache, Config &config);
     ~our(){
-        capacity_file.close();
+        capacity_file.Close();
         utilization_file.close();
-        searching_file.close();
+        searching_file.Close();
     };
     void Refill(uint64_t req_id) override;
     void Drained() override;
+    uint64_t NextEventCycle() const override;
     void WarmUp(uint64_t hex_addr, bool is_write) override;
+    void SaveState(StateWriter &w) const override;
+    bool LoadState(StateReader &r) override;
     void PrintStat() override;
 };
 }
@@ -1,14 +1,19 @@
 #include "refresh.h"
 
 namespace dramsim3 {
-Refresh::Refresh(const Config &config, ChannelState &channel_state)
+Refresh::Refresh(const Config &config, ChannelState &channel_state,
+                 const CommandQueue &cmd_queue)
     : clk_(0),
       config_(config),
       channel_state_(channel_state),
+      cmd_queue_(cmd_queue),
       refresh_policy_(config.refresh_policy),
       next_rank_(0),
       next_bg_(0),
-      next_bank_(0) {
+      next_bank_(0),
+      postpone_(config.refresh_postpone),
+      pullin_(config.refresh_pullin),
+      poll_(0) {
     if (refresh_policy_ == RefreshPolicy::RANK_LEVEL_SIMULTANEOUS) {
         refresh_interval_ = config_.tREFI;
     } else if (refresh_policy_ == RefreshPolicy::BANK_LEVEL_STAGGERED) {
@@ -16,23 +21,106 @@ Refresh::Refresh(const Config &config, ChannelState &channel_state)
     } else {  // default refresh scheme: RANK STAGGERED
         refresh_interval_ = config_.tREFI / config_.ranks;
     }
+    next_due_ = refresh_interval_;
+    if (refresh_policy_ == RefreshPolicy::BANK_LEVEL_STAGGERED) {
+        balance_.resize(config_.ranks * config_.banks, 0);
+    } else {
+        balance_.resize(config_.ranks, 0);
+    }
+    pending_ = pullin_ > 0 ? static_cast<int>(balance_.size()) : 0;
 }
 
 void Refresh::ClockTick() {
-    if (clk_ % refresh_interval_ == 0 && clk_ > 0) {
+    if (clk_ == next_due_) {
         InsertRefresh();
+        next_due_ += refresh_interval_;
+    }
+    if (pending_ > 0) {
+        int unit = poll_;
+        poll_ = (poll_ + 1) % balance_.size();
+        if (balance_[unit] < pullin_ && CanRefreshEarly(unit)) {
+            NeedRefresh(unit);
+        }
     }
     clk_++;
     return;
 }
 
+uint64_t Refresh::NextRefreshCycle() const {
+    if (pending_ > 0) {
+        // nothing changes while the controller is idle, either some unit
+        // can be refreshed now or none until the next due refresh
+        for (size_t i = 0; i < balance_.size(); i++) {
+            if (balance_[i] < pullin_ && CanRefreshEarly(i)) {
+                return clk_;
+            }
+        }
+    }
+    return next_due_;
+}
+
+void Refresh::FastForward(uint64_t cycles) {
+    clk_ += cycles;
+    if (pending_ > 0) {
+        poll_ = (poll_ + cycles) % balance_.size();
+    }
+}
+
+void Refresh::Due(int unit) {
+    if (balance_[unit] == pullin_) {
+        pending_++;
+    }
+    balance_[unit]--;
+    // held back only while the rank is busy
+    if (balance_[unit] < -postpone_ ||
+        (balance_[unit] < 0 && CanRefreshEarly(unit))) {
+        NeedRefresh(unit);
+    }
+}
+
+bool Refresh::CanRefreshEarly(int unit) const {
+    int rank = UnitRank(unit);
+    if (channel_state_.IsRankSelfRefreshing(rank) ||
+        channel_state_.IsRefreshPending(rank)) {
+        return false;
+    }
+    if (refresh_policy_ == RefreshPolicy::BANK_LEVEL_STAGGERED) {
+        int bank = unit % config_.banks;
+        return cmd_queue_.IsIdle(rank, bank / config_.banks_per_group,
+                                 bank % config_.banks_per_group);
+    }
+    return cmd_queue_.IsIdle(rank, -1, -1);
+}
+
+void Refresh::NeedRefresh(int unit) {
+    int rank = UnitRank(unit);
+    if (refresh_policy_ == RefreshPolicy::BANK_LEVEL_STAGGERED) {
+        int bank = unit % config_.banks;
+        channel_state_.BankNeedRefresh(rank, bank / config_.banks_per_group,
+                                       bank % config_.banks_per_group, true);
+    } else {
+        channel_state_.RankNeedRefresh(rank, true);
+    }
+    balance_[unit]++;
+    if (balance_[unit] == pullin_) {
+        pending_--;
+    }
+}
+
+int Refresh::UnitRank(int unit) const {
+    if (refresh_policy_ == RefreshPolicy::BANK_LEVEL_STAGGERED) {
+        return unit / config_.banks;
+    }
+    return unit;
+}
+
 void Refresh::InsertRefresh() {
     switch (refresh_policy_) {
         // Simultaneous all rank refresh
         case RefreshPolicy::RANK_LEVEL_SIMULTANEOUS:
             for (auto i = 0; i < config_.ranks; i++) {
                 if (!channel_state_.IsRankSelfRefreshing(i)) {
-                    channel_state_.RankNeedRefresh(i, true);
+                    Due(i);
                     break;
                 }
             }
@@ -40,15 +128,16 @@ void Refresh::InsertRefresh() {
         // Staggered all rank refresh
         case RefreshPolicy::RANK_LEVEL_STAGGERED:
             if (!channel_state_.IsRankSelfRefreshing(next_rank_)) {
-                channel_state_.RankNeedRefresh(next_rank_, true);
+                Due(next_rank_);
             }
             IterateNext();
             break;
         // Fully staggered per bank refresh
         case RefreshPolicy::BANK_LEVEL_STAGGERED:
             if (!channel_state_.IsRankSelfRefreshing(next_rank_)) {
-                channel_state_.BankNeedRefresh(next_rank_, next_bg_, next_bank_,
-                                               true);
+                Due((next_rank_ * config_.bankgroups + next_bg_) *
+                        config_.banks_per_group +
+                    next_bank_);
             }
             IterateNext();
             break;
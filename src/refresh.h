@@ -3,26 +3,56 @@
 
 #include <vector>
 #include "channel_state.h"
+#include "command_queue.h"
 #include "common.h"
 #include "configuration.h"
 
 namespace dramsim3 {
 
+// Refreshes are due every refresh interval, one rank (or bank) after
+// another. With refresh_postpone a due refresh of a rank that has queued
+// commands is held back, up to that many per rank, and issued once the
+// rank is idle; with refresh_pullin up to that many are issued ahead of
+// time while the rank is idle and skipped when they fall due. A refresh
+// is forced as soon as the postponement limit is reached.
 class Refresh {
    public:
-    Refresh(const Config& config, ChannelState& channel_state);
+    Refresh(const Config& config, ChannelState& channel_state,
+            const CommandQueue& cmd_queue);
     void ClockTick();
+    // the clock at which ClockTick() inserts the next refresh
+    uint64_t NextRefreshCycle() const;
+    void FastForward(uint64_t cycles);
 
    private:
     uint64_t clk_;
     int refresh_interval_;
     const Config& config_;
     ChannelState& channel_state_;
+    const CommandQueue& cmd_queue_;
     RefreshPolicy refresh_policy_;
 
     int next_rank_, next_bg_, next_bank_;
+    // clock the next refresh is due at
+    uint64_t next_due_;
+
+    // refreshes issued minus refreshes due of each rank (or bank), from
+    // -postpone_ to pullin_
+    std::vector<int> balance_;
+    int postpone_;
+    int pullin_;
+    // number of units with balance_ below pullin_, while there are any
+    // ClockTick() checks one unit per clock, round robin from poll_
+    int pending_;
+    int poll_;
 
     void InsertRefresh();
+    void Due(int unit);
+    // no command of the unit is queued and its rank is awake with no
+    // refresh waiting
+    bool CanRefreshEarly(int unit) const;
+    void NeedRefresh(int unit);
+    int UnitRank(int unit) const;
 
     void IterateNext();
 };
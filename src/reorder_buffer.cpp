@@ -0,0 +1,65 @@
+#include "reorder_buffer.h"
+
+namespace dramsim3 {
+
+ReorderBuffer::ReorderBuffer(size_t capacity) : head_(0), wait_(0), tail_(0) {
+    size_t sz = 1;
+    while (sz < capacity) sz <<= 1;
+    ring_.resize(sz);
+    mask_ = sz - 1;
+}
+
+void ReorderBuffer::Push(const HMTTTransaction &trans) {
+    if (Size() == ring_.size()) {
+        std::vector<HMTTTransaction> ring(ring_.size() * 2);
+        uint64_t mask = ring.size() - 1;
+        for (uint64_t s = head_; s != tail_; s++) {
+            ring[s & mask] = At(s);
+        }
+        ring_.swap(ring);
+        mask_ = mask;
+    }
+    At(tail_++) = trans;
+}
+
+bool ReorderBuffer::WaitingDepends() const {
+    return HasWaiting() && issued_.count(At(wait_).addr) > 0;
+}
+
+void ReorderBuffer::Issue() {
+    issued_.emplace(At(wait_).addr, wait_);
+    wait_++;
+}
+
+HMTTTransaction *ReorderBuffer::FindIssuedRead(uint64_t addr) {
+    HMTTTransaction *res = nullptr;
+    uint64_t oldest = tail_;
+    auto range = issued_.equal_range(addr);
+    for (auto i = range.first; i != range.second; ++i) {
+        if (i->second < oldest && At(i->second).r_w == 1) {
+            oldest = i->second;
+            res = &At(i->second);
+        }
+    }
+    return res;
+}
+
+void ReorderBuffer::Retire() {
+    while (head_ != wait_ && At(head_).is_finished) {
+        auto range = issued_.equal_range(At(head_).addr);
+        for (auto i = range.first; i != range.second; ++i) {
+            if (i->second == head_) {
+                issued_.erase(i);
+                break;
+            }
+        }
+        head_++;
+    }
+}
+
+void ReorderBuffer::Clear() {
+    head_ = wait_ = tail_ = 0;
+    issued_.clear();
+}
+
+}  // namespace dramsim3
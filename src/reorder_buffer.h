@@ -0,0 +1,51 @@
+#ifndef DRAMSIM3_REORDER_BUFFER_H
+#define DRAMSIM3_REORDER_BUFFER_H
+#include <unordered_map>
+#include <vector>
+#include "common.h"
+
+namespace dramsim3 {
+
+// In-order ROB of HMTTCPU. Entries live in a ring indexed by sequence
+// numbers; [head, wait) have been issued, [wait, tail) still wait. Issued
+// entries are indexed by address, so the same-address dependency check and
+// matching a read completion do not scan the ROB.
+class ReorderBuffer {
+   public:
+    // the ring doubles if `capacity` is exceeded, entries are only bounded
+    // by time in HMTTCPU
+    explicit ReorderBuffer(size_t capacity = 64);
+    bool Empty() const { return head_ == tail_; }
+    size_t Size() const { return tail_ - head_; }
+    HMTTTransaction &Front() { return At(head_); }
+    void Push(const HMTTTransaction &trans);
+
+    // the oldest entry not issued yet
+    bool HasWaiting() const { return wait_ != tail_; }
+    HMTTTransaction &Waiting() { return At(wait_); }
+    // an issued entry, finished or not, has the address of Waiting()
+    bool WaitingDepends() const;
+    // moves Waiting() into the issued part
+    void Issue();
+
+    // the oldest issued read of `addr`, nullptr if there is none
+    HMTTTransaction *FindIssuedRead(uint64_t addr);
+    // removes finished entries from the head, stopping at Waiting()
+    void Retire();
+    void Clear();
+
+   private:
+    HMTTTransaction &At(uint64_t seq) { return ring_[seq & mask_]; }
+    const HMTTTransaction &At(uint64_t seq) const { return ring_[seq & mask_]; }
+
+    std::vector<HMTTTransaction> ring_;
+    uint64_t mask_;
+    uint64_t head_;
+    uint64_t wait_;
+    uint64_t tail_;
+    // address -> sequence number of the issued entries
+    std::unordered_multimap<uint64_t, uint64_t> issued_;
+};
+
+}  // namespace dramsim3
+#endif  // DRAMSIM3_REORDER_BUFFER_H
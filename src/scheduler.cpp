@@ -0,0 +1,116 @@
+#include "scheduler.h"
+#include <iostream>
+
+namespace dramsim3 {
+
+bool TransactionScheduler::IsRowHit(const Command &cmd) const {
+    if (!channel_state_.IsRowOpen(cmd.Rank(), cmd.Bankgroup(), cmd.Bank()) ||
+        channel_state_.OpenRow(cmd.Rank(), cmd.Bankgroup(), cmd.Bank()) !=
+            cmd.Row()) {
+        return false;
+    }
+    return row_hit_cap_ == 0 ||
+           channel_state_.RowHitCount(cmd.Rank(), cmd.Bankgroup(),
+                                      cmd.Bank()) < row_hit_cap_;
+}
+
+BLISSScheduler::BLISSScheduler(const Config &config,
+                               const ChannelState &channel_state)
+    : TransactionScheduler(config, channel_state),
+      last_source_(-1),
+      streak_(0),
+      next_clear_(config.bliss_clear_interval > 0 ? config.bliss_clear_interval
+                                                  : UINT64_MAX) {
+    blacklisted_[0] = blacklisted_[1] = false;
+}
+
+void BLISSScheduler::Clear(uint64_t clk) {
+    blacklisted_[0] = blacklisted_[1] = false;
+    while (next_clear_ <= clk) {
+        next_clear_ += config_.bliss_clear_interval;
+    }
+}
+
+size_t BLISSScheduler::Pick(const std::vector<Transaction> &queue,
+                            const std::vector<SchedCandidate> &candidates,
+                            uint64_t clk) {
+    if (clk >= next_clear_) {
+        Clear(clk);
+    }
+    size_t i = FirstRowHit(candidates, [&](const SchedCandidate &c) {
+        return !blacklisted_[queue[c.index].is_write ? 1 : 0];
+    });
+    return i == candidates.size() ? FirstRowHit(candidates, Any) : i;
+}
+
+void BLISSScheduler::Scheduled(const Transaction &trans, const Command &cmd,
+                               uint64_t clk) {
+    int source = trans.is_write ? 1 : 0;
+    if (source == last_source_) {
+        if (++streak_ > config_.bliss_threshold) {
+            blacklisted_[source] = true;
+        }
+    } else {
+        last_source_ = source;
+        streak_ = 1;
+    }
+}
+
+void PARBSScheduler::FormBatch(const std::vector<Transaction> &queue) {
+    std::vector<int> per_bank(config_.ranks * config_.banks, 0);
+    for (const auto &trans : queue) {
+        auto addr = config_.AddressMapping(trans.addr);
+        int bank = addr.rank * config_.banks +
+                   addr.bankgroup * config_.banks_per_group + addr.bank;
+        if (per_bank[bank]++ < config_.batch_cap) {
+            batch_.insert(trans.seq);
+        }
+    }
+}
+
+size_t PARBSScheduler::Pick(const std::vector<Transaction> &queue,
+                            const std::vector<SchedCandidate> &candidates,
+                            uint64_t clk) {
+    // the batch is done once none of it is left in this queue
+    bool batch_left = false;
+    for (const auto &trans : queue) {
+        if (batch_.count(trans.seq) != 0) {
+            batch_left = true;
+            break;
+        }
+    }
+    if (!batch_left) {
+        batch_.clear();
+        FormBatch(queue);
+    }
+    size_t i = FirstRowHit(candidates, [&](const SchedCandidate &c) {
+        return batch_.count(queue[c.index].seq) != 0;
+    });
+    return i == candidates.size() ? FirstRowHit(candidates, Any) : i;
+}
+
+void PARBSScheduler::Scheduled(const Transaction &trans, const Command &cmd,
+                               uint64_t clk) {
+    batch_.erase(trans.seq);
+}
+
+TransactionScheduler *MakeTransactionScheduler(
+    const Config &config, const ChannelState &channel_state) {
+    if (config.trans_scheduler == "FCFS") {
+        return new FCFSScheduler(config, channel_state);
+    } else if (config.trans_scheduler == "FRFCFS") {
+        return new FRFCFSScheduler(config, channel_state);
+    } else if (config.trans_scheduler == "FRFCFS_CAP") {
+        return new FRFCFSScheduler(config, channel_state, config.row_hit_cap);
+    } else if (config.trans_scheduler == "BLISS") {
+        return new BLISSScheduler(config, channel_state);
+    } else if (config.trans_scheduler == "PARBS") {
+        return new PARBSScheduler(config, channel_state);
+    }
+    std::cerr << "Unsupported transaction scheduler " << config.trans_scheduler
+              << std::endl;
+    AbruptExit(__FILE__, __LINE__);
+    return nullptr;
+}
+
+}  // namespace dramsim3
@@ -0,0 +1,136 @@
+#ifndef DRAMSIM3_SCHEDULER_H
+#define DRAMSIM3_SCHEDULER_H
+#include <unordered_set>
+#include <vector>
+#include "channel_state.h"
+#include "common.h"
+#include "configuration.h"
+
+namespace dramsim3 {
+
+// a queued transaction whose bank command queue has room
+struct SchedCandidate {
+    size_t index;
+    Command cmd;
+};
+
+// Chooses which queued transaction of a controller becomes a command next,
+// selected by `scheduler` in [system]:
+//   FCFS        oldest first
+//   FRFCFS      row hits first, then oldest
+//   FRFCFS_CAP  as FRFCFS, a bank's hits lose priority after row_hit_cap
+//   BLISS       as FRFCFS behind a blacklist of streaming sources
+//   PARBS       as FRFCFS within batches of batch_cap per bank
+class TransactionScheduler {
+   public:
+    TransactionScheduler(const Config &config, const ChannelState &channel_state)
+        : config_(config), channel_state_(channel_state), row_hit_cap_(0) {}
+    virtual ~TransactionScheduler() {}
+    // a candidate index, candidates are in queue (arrival) order and not
+    // empty
+    virtual size_t Pick(const std::vector<Transaction> &queue,
+                        const std::vector<SchedCandidate> &candidates,
+                        uint64_t clk) = 0;
+    // the picked transaction went to the command queue
+    virtual void Scheduled(const Transaction &trans, const Command &cmd,
+                           uint64_t clk) {}
+    // false if Pick() only looks at the first candidate
+    virtual bool NeedsAllCandidates() const { return true; }
+
+   protected:
+    // the command goes to the open row of its bank, and the bank has had
+    // fewer than row_hit_cap_ hits on it if there is a cap
+    bool IsRowHit(const Command &cmd) const;
+    // first row hit among the candidates `prefer` accepts, else the first
+    // of them, candidates.size() if it accepts none
+    template <typename Pred>
+    size_t FirstRowHit(const std::vector<SchedCandidate> &candidates,
+                       Pred prefer) const {
+        size_t first = candidates.size();
+        for (size_t i = 0; i < candidates.size(); i++) {
+            if (!prefer(candidates[i])) continue;
+            if (IsRowHit(candidates[i].cmd)) return i;
+            if (first == candidates.size()) first = i;
+        }
+        return first;
+    }
+    static bool Any(const SchedCandidate &) { return true; }
+
+    const Config &config_;
+    const ChannelState &channel_state_;
+    int row_hit_cap_;
+};
+
+class FCFSScheduler : public TransactionScheduler {
+   public:
+    using TransactionScheduler::TransactionScheduler;
+    size_t Pick(const std::vector<Transaction> &queue,
+                const std::vector<SchedCandidate> &candidates,
+                uint64_t clk) override {
+        return 0;
+    }
+    bool NeedsAllCandidates() const override { return false; }
+};
+
+class FRFCFSScheduler : public TransactionScheduler {
+   public:
+    // cap of 0 lets row hits go first however many the bank had
+    FRFCFSScheduler(const Config &config, const ChannelState &channel_state,
+                    int cap = 0)
+        : TransactionScheduler(config, channel_state) {
+        row_hit_cap_ = cap;
+    }
+    size_t Pick(const std::vector<Transaction> &queue,
+                const std::vector<SchedCandidate> &candidates,
+                uint64_t clk) override {
+        return FirstRowHit(candidates, Any);
+    }
+};
+
+// Subramanian et al., "The Blacklisting Memory Scheduler". A controller
+// sees no thread ids; reads and writes are the two sources, so a burst of
+// refill or write-back traffic is blacklisted behind demand reads. Both
+// only meet in a unified queue, so Config rejects BLISS without one.
+class BLISSScheduler : public TransactionScheduler {
+   public:
+    BLISSScheduler(const Config &config, const ChannelState &channel_state);
+    size_t Pick(const std::vector<Transaction> &queue,
+                const std::vector<SchedCandidate> &candidates,
+                uint64_t clk) override;
+    void Scheduled(const Transaction &trans, const Command &cmd,
+                   uint64_t clk) override;
+
+   private:
+    void Clear(uint64_t clk);
+
+    int last_source_;
+    int streak_;
+    bool blacklisted_[2];
+    uint64_t next_clear_;
+};
+
+// Mutlu and Moscibroda, "Parallelism-Aware Batch Scheduling". Up to
+// batch_cap oldest transactions per bank form a batch that goes before
+// anything newer, row hits first within it. Without thread ids there is
+// no ranking inside a batch.
+class PARBSScheduler : public TransactionScheduler {
+   public:
+    using TransactionScheduler::TransactionScheduler;
+    size_t Pick(const std::vector<Transaction> &queue,
+                const std::vector<SchedCandidate> &candidates,
+                uint64_t clk) override;
+    void Scheduled(const Transaction &trans, const Command &cmd,
+                   uint64_t clk) override;
+
+   private:
+    void FormBatch(const std::vector<Transaction> &queue);
+
+    // Transaction::seq of the batch members
+    std::unordered_set<uint64_t> batch_;
+};
+
+TransactionScheduler *MakeTransactionScheduler(const Config &config,
+                                               const ChannelState &channel_state);
+
+}  // namespace dramsim3
+#endif  // DRAMSIM3_SCHEDULER_H
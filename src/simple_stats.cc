@@ -5,6 +5,8 @@
 
 namespace dramsim3 {
 
+const char kEpochMagic[8] = {'D', 'S', '3', 'E', 'P', 'O', 'C', 'H'};
+
 template <class T>
 void PrintStatText(std::ostream& where, std::string name, T value,
                    std::string description) {
@@ -77,13 +79,31 @@ SimpleStats::SimpleStats(const Config& config, int channel_id)
              "Average request interarrival latency (cycles)");
 }
 
-void SimpleStats::AddValue(const std::string name, const int value) {
-    auto& epoch_counts = epoch_histo_counts_[name];
-    if (epoch_counts.count(value) <= 0) {
-        epoch_counts[value] = 1;
-    } else {
-        epoch_counts[value] += 1;
+int SimpleStats::CounterId(const std::string& name) const {
+    auto it = counter_ids_.find(name);
+    if (it == counter_ids_.end()) {
+        std::cerr << "Unknown counter stat " << name << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    return it->second;
+}
+
+int SimpleStats::VecCounterId(const std::string& name) const {
+    auto it = vec_counter_ids_.find(name);
+    if (it == vec_counter_ids_.end()) {
+        std::cerr << "Unknown vector counter stat " << name << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    return it->second.first;
+}
+
+int SimpleStats::HistoId(const std::string& name) const {
+    auto it = histo_ids_.find(name);
+    if (it == histo_ids_.end()) {
+        std::cerr << "Unknown histogram stat " << name << std::endl;
+        AbruptExit(__FILE__, __LINE__);
     }
+    return it->second;
 }
 
 std::string SimpleStats::GetTextHeader(bool is_final) const {
@@ -92,7 +112,7 @@ std::string SimpleStats::GetTextHeader(bool is_final) const {
         "Channel " +
         std::to_string(channel_id_);
     if (!is_final) {
-        header += " of epoch " + std::to_string(counters_.at("epoch_num"));
+        header += " of epoch " + std::to_string(Counter("epoch_num", false));
     }
     header += "\n###########################################\n";
     return header;
@@ -104,11 +124,14 @@ double SimpleStats::RankBackgroundEnergy(const int rank) const{
            vec_doubles_.at("sref_energy")[rank];
 }
 
-void SimpleStats::PrintEpochStats() {
+void SimpleStats::PrintEpochStats(StatsSink* sink) {
     UpdateEpochStats();
-    if (config_.output_level >= 1) {
-        std::ofstream j_out(config_.json_epoch_name, std::ofstream::app);
-        j_out << j_data_;
+    if (config_.output_level >= 1 && sink != nullptr) {
+        if (config_.epoch_format == "binary") {
+            PutBinaryEpoch(*sink);
+        } else {
+            *sink << j_data_;
+        }
     }
     if (config_.output_level >= 2) {
         std::cout << GetTextHeader(false);
@@ -120,6 +143,37 @@ void SimpleStats::PrintEpochStats() {
     print_pairs_.clear();
 }
 
+void SimpleStats::PutBinaryEpoch(StatsSink& sink) {
+    // vector stats become one field per element, name.index
+    std::vector<std::string> fields;
+    std::vector<double> values;
+    for (auto it = j_data_.begin(); it != j_data_.end(); ++it) {
+        if (it->is_number()) {
+            fields.push_back(it.key());
+            values.push_back(it->get<double>());
+        } else if (it->is_object()) {
+            for (auto e = it->begin(); e != it->end(); ++e) {
+                fields.push_back(it.key() + "." + e.key());
+                values.push_back(e->get<double>());
+            }
+        }
+    }
+    if (fields != epoch_fields_) {
+        epoch_fields_ = fields;
+        sink.Put<uint8_t>(0);
+        sink.Put<uint32_t>(channel_id_);
+        sink.Put<uint32_t>(fields.size());
+        for (const auto& it : fields) {
+            sink.Put<uint16_t>(it.size());
+            sink.Write(it.data(), it.size());
+        }
+    }
+    sink.Put<uint8_t>(1);
+    sink.Put<uint32_t>(channel_id_);
+    sink.Put<uint32_t>(values.size());
+    sink.Write(values.data(), values.size() * sizeof(double));
+}
+
 void SimpleStats::PrintFinalStats() {
     UpdateFinalStats();
 
@@ -144,18 +198,10 @@ void SimpleStats::PrintFinalStats() {
 }
 
 void SimpleStats::Reset() {
-    for (auto& it : counters_) {
-        it.second = 0;
-    }
-    for (auto& it : epoch_counters_) {
-        it.second = 0;
-    }
-    for (auto& vec : vec_counters_) {
-        std::fill(vec.second.begin(), vec.second.end(), 0);
-    }
-    for (auto& vec : epoch_vec_counters_) {
-        std::fill(vec.second.begin(), vec.second.end(), 0);
-    }
+    std::fill(counters_.begin(), counters_.end(), 0);
+    std::fill(epoch_counters_.begin(), epoch_counters_.end(), 0);
+    std::fill(vec_counters_.begin(), vec_counters_.end(), 0);
+    std::fill(epoch_vec_counters_.begin(), epoch_vec_counters_.end(), 0);
     for (auto& it : doubles_) {
         it.second = 0.0;
     }
@@ -166,10 +212,10 @@ void SimpleStats::Reset() {
         it.second = 0.0;
     }
     for (auto& it : histo_counts_) {
-        it.second.clear();
+        it.Clear();
     }
     for (auto& it : epoch_histo_counts_) {
-        it.second.clear();
+        it.Clear();
     }
 }
 
@@ -177,8 +223,9 @@ void SimpleStats::InitStat(std::string name, std::string stat_type,
                            std::string description) {
     header_descs_.emplace(name, description);
     if (stat_type == "counter") {
-        counters_.emplace(name, 0);
-        epoch_counters_.emplace(name, 0);
+        counter_ids_.emplace(name, counters_.size());
+        counters_.push_back(0);
+        epoch_counters_.push_back(0);
     } else if (stat_type == "double") {
         doubles_.emplace(name, 0.0);
     } else if (stat_type == "calculated") {
@@ -196,8 +243,10 @@ void SimpleStats::InitVecStat(std::string name, std::string stat_type,
         header_descs_.emplace(actual_name, actual_desc);
     }
     if (stat_type == "vec_counter") {
-        vec_counters_.emplace(name, std::vector<uint64_t>(vec_len, 0));
-        epoch_vec_counters_.emplace(name, std::vector<uint64_t>(vec_len, 0));
+        int offset = vec_counters_.size();
+        vec_counter_ids_.emplace(name, std::make_pair(offset, vec_len));
+        vec_counters_.resize(vec_counters_.size() + vec_len, 0);
+        epoch_vec_counters_.resize(epoch_vec_counters_.size() + vec_len, 0);
     } else if (stat_type == "vec_double") {
         vec_doubles_.emplace(name, std::vector<double>(vec_len, 0));
     }
@@ -208,8 +257,12 @@ void SimpleStats::InitHistoStat(std::string name, std::string description,
     int bin_width = (end_val - start_val) / num_bins;
     bin_widths_.emplace(name, bin_width);
     histo_bounds_.emplace(name, std::make_pair(start_val, end_val));
-    histo_counts_.emplace(name, std::unordered_map<int, uint64_t>());
-    epoch_histo_counts_.emplace(name, std::unordered_map<int, uint64_t>());
+    histo_ids_.emplace(name, histo_counts_.size());
+    // a bucket per value up to end_val
+    int sub_bits = 8;
+    while (sub_bits < 16 && (1 << sub_bits) <= end_val) sub_bits++;
+    histo_counts_.push_back(LogHistogram(sub_bits));
+    epoch_histo_counts_.push_back(LogHistogram(sub_bits));
 
     // initialize headers, descriptions
     std::vector<std::string> headers;
@@ -228,6 +281,10 @@ void SimpleStats::InitHistoStat(std::string name, std::string description,
     header_descs_.emplace(header, description);
 
     histo_headers_.emplace(name, headers);
+    for (const auto& it : LogHistogram().Summary()) {
+        header_descs_.emplace(name + "_" + it.first,
+                              description + " " + it.first);
+    }
 
     // +2 for front and end
     histo_bins_.emplace(name, std::vector<uint64_t>(num_bins + 2, 0));
@@ -235,13 +292,11 @@ void SimpleStats::InitHistoStat(std::string name, std::string description,
 }
 
 void SimpleStats::UpdateCounters() {
-    for (const auto& it : epoch_counters_) {
-        counters_[it.first] += it.second;
+    for (size_t i = 0; i < epoch_counters_.size(); i++) {
+        counters_[i] += epoch_counters_[i];
     }
-    for (const auto& vec : epoch_vec_counters_) {
-        for (size_t i = 0; i < vec.second.size(); i++) {
-            vec_counters_[vec.first][i] += vec.second[i];
-        }
+    for (size_t i = 0; i < epoch_vec_counters_.size(); i++) {
+        vec_counters_[i] += epoch_vec_counters_[i];
     }
 }
 
@@ -250,34 +305,27 @@ void SimpleStats::UpdateHistoBins() {
         const auto& name = name_bins.first;
         auto& bins = name_bins.second;
         std::fill(bins.begin(), bins.end(), 0);
-        for (const auto it : epoch_histo_counts_[name]) {
-            int value = it.first;
-            uint64_t count = it.second;
-            int bin_idx = 0;
-            if (value < histo_bounds_[name].first) {
-                bin_idx = 0;
-            } else if (value > histo_bounds_[name].second) {
-                bin_idx = bins.size() - 1;
-            } else {
-                bin_idx =
-                    (value - histo_bounds_[name].first) / bin_widths_[name] + 1;
-            }
-            bins[bin_idx] += count;
-        }
+        const auto& bounds = histo_bounds_[name];
+        int bin_width = bin_widths_[name];
+        epoch_histo_counts_[histo_ids_[name]].ForEach(
+            [&](uint64_t low, uint64_t, uint64_t count) {
+                int bin_idx = 0;
+                if (low > static_cast<uint64_t>(bounds.second)) {
+                    bin_idx = bins.size() - 1;
+                } else if (static_cast<int>(low) < bounds.first) {
+                    bin_idx = 0;
+                } else {
+                    bin_idx = (low - bounds.first) / bin_width + 1;
+                }
+                bins[bin_idx] += count;
+            });
     }
 
     // update overall histogram counts based on epoch histo counts
-    for (auto& name_counts : epoch_histo_counts_) {
-        const auto& name = name_counts.first;
-        auto& epoch_counts = name_counts.second;
-        auto& final_counts = histo_counts_[name];
-        for (const auto& val_cnt : epoch_counts) {
-            if (final_counts.count(val_cnt.first) <= 0) {
-                final_counts[val_cnt.first] = val_cnt.second;
-            } else {
-                final_counts[val_cnt.first] += val_cnt.second;
-            }
-        }
+    for (const auto& name_id : histo_ids_) {
+        const auto& name = name_id.first;
+        int id = name_id.second;
+        histo_counts_[id].Merge(epoch_histo_counts_[id]);
         auto& final_bins = histo_bins_[name];
         for (size_t i = 0; i < final_bins.size(); i++) {
             final_bins[i] += epoch_histo_bins_[name][i];
@@ -300,21 +348,24 @@ double SimpleStats::GetHistoAvg(const HistoCount& hist_counts) {
 void SimpleStats::UpdatePrints(bool epoch) {
     j_data_["channel"] = channel_id_;
 
-    std::unordered_map<std::string, uint64_t>& ref_counters =
+    const std::vector<uint64_t>& ref_counters =
         epoch ? epoch_counters_ : counters_;
-    for (const auto& it : ref_counters) {
-        print_pairs_.emplace_back(it.first, std::to_string(it.second));
-        j_data_[it.first] = it.second;
+    for (const auto& it : counter_ids_) {
+        uint64_t value = ref_counters[it.second];
+        print_pairs_.emplace_back(it.first, std::to_string(value));
+        j_data_[it.first] = value;
     }
-    j_data_["epoch_num"] = counters_["epoch_num"];
+    j_data_["epoch_num"] = Counter("epoch_num", false);
 
-    VecStat& ref_vcounter = epoch ? epoch_vec_counters_ : vec_counters_;
-    for (const auto& it : ref_vcounter) {
+    const std::vector<uint64_t>& ref_vcounter =
+        epoch ? epoch_vec_counters_ : vec_counters_;
+    for (const auto& it : vec_counter_ids_) {
         Json j_list;
-        for (size_t i = 0; i < it.second.size(); i++) {
+        for (int i = 0; i < it.second.second; i++) {
+            uint64_t value = ref_vcounter[it.second.first + i];
             std::string name = it.first + "." + std::to_string(i);
-            print_pairs_.emplace_back(name, std::to_string(it.second[i]));
-            j_list[std::to_string(i)] = it.second[i];
+            print_pairs_.emplace_back(name, std::to_string(value));
+            j_list[std::to_string(i)] = value;
         }
         j_data_[it.first] = j_list;
     }
@@ -326,17 +377,26 @@ void SimpleStats::UpdatePrints(bool epoch) {
             j_data_[names[i]] = it.second[i];
         }
     }
+    auto& ref_hist = epoch ? epoch_histo_counts_ : histo_counts_;
+    for (const auto& name_id : histo_ids_) {
+        for (const auto& it : ref_hist[name_id.second].Summary()) {
+            std::string name = name_id.first + "_" + it.first;
+            print_pairs_.emplace_back(name, std::to_string(it.second));
+            j_data_[name] = it.second;
+        }
+    }
 
     // if we dump complete histogram data each epoch the output file will be
     // huge therefore we only put aggregated histo in each epoch but
     // complete data at the end
     if (!epoch) {
-        for (const auto& name_hist : histo_counts_) {
+        for (const auto& name_id : histo_ids_) {
             Json j_list;
-            for (const auto& it : name_hist.second) {
-                j_list[std::to_string(it.first)] = it.second;
-            }
-            j_data_[name_hist.first] = j_list;
+            histo_counts_[name_id.second].ForEach(
+                [&j_list](uint64_t low, uint64_t, uint64_t count) {
+                    j_list[std::to_string(low)] = count;
+                });
+            j_data_[name_id.first] = j_list;
         }
     }
 
@@ -366,25 +426,25 @@ void SimpleStats::UpdateEpochStats() {
 
     // update computed stats
     doubles_["act_energy"] =
-        epoch_counters_["num_act_cmds"] * config_.act_energy_inc;
+        Counter("num_act_cmds", true) * config_.act_energy_inc;
     doubles_["read_energy"] =
-        epoch_counters_["num_read_cmds"] * config_.read_energy_inc;
+        Counter("num_read_cmds", true) * config_.read_energy_inc;
     doubles_["write_energy"] =
-        epoch_counters_["num_write_cmds"] * config_.write_energy_inc;
+        Counter("num_write_cmds", true) * config_.write_energy_inc;
     doubles_["ref_energy"] =
-        epoch_counters_["num_ref_cmds"] * config_.ref_energy_inc;
+        Counter("num_ref_cmds", true) * config_.ref_energy_inc;
     doubles_["refb_energy"] =
-        epoch_counters_["num_refb_cmds"] * config_.refb_energy_inc;
+        Counter("num_refb_cmds", true) * config_.refb_energy_inc;
 
     // vector doubles, update first, then push
     double background_energy = 0.0;
     for (int i = 0; i < config_.ranks; i++) {
-        double act_stb = epoch_vec_counters_["rank_active_cycles"][i] *
+        double act_stb = VecCounter("rank_active_cycles", i, true) *
                          config_.act_stb_energy_inc;
-        double pre_stb = epoch_vec_counters_["all_bank_idle_cycles"][i] *
+        double pre_stb = VecCounter("all_bank_idle_cycles", i, true) *
                          config_.pre_stb_energy_inc;
         double sref_energy =
-            epoch_vec_counters_["sref_cycles"][i] * config_.sref_energy_inc;
+            VecCounter("sref_cycles", i, true) * config_.sref_energy_inc;
         vec_doubles_["act_stb_energy"][i] = act_stb;
         vec_doubles_["pre_stb_energy"][i] = pre_stb;
         vec_doubles_["sref_energy"][i] = sref_energy;
@@ -395,8 +455,8 @@ void SimpleStats::UpdateEpochStats() {
 
     // calculated stats
     uint64_t total_reqs =
-        epoch_counters_["num_reads_done"] + epoch_counters_["num_writes_done"];
-    double total_time = epoch_counters_["num_cycles"] * config_.tCK;
+        Counter("num_reads_done", true) + Counter("num_writes_done", true);
+    double total_time = Counter("num_cycles", true) * config_.tCK;
     double avg_bw = total_reqs * config_.request_size_bytes / total_time;
     calculated_["average_bandwidth"] = avg_bw;
 
@@ -404,21 +464,17 @@ void SimpleStats::UpdateEpochStats() {
                           doubles_["write_energy"] + doubles_["ref_energy"] +
                           doubles_["refb_energy"] + background_energy;
     calculated_["total_energy"] = total_energy;
-    calculated_["average_power"] = total_energy / epoch_counters_["num_cycles"];
+    calculated_["average_power"] = total_energy / Counter("num_cycles", true);
     calculated_["average_read_latency"] =
-        GetHistoAvg(epoch_histo_counts_.at("read_latency"));
+        epoch_histo_counts_[HistoId("read_latency")].Mean();
     calculated_["average_interarrival"] =
-        GetHistoAvg(epoch_histo_counts_.at("interarrival_latency"));
+        epoch_histo_counts_[HistoId("interarrival_latency")].Mean();
 
     UpdatePrints(true);
-    for (auto& it : epoch_counters_) {
-        it.second = 0;
-    }
-    for (auto& vec : epoch_vec_counters_) {
-        std::fill(vec.second.begin(), vec.second.end(), 0);
-    }
+    std::fill(epoch_counters_.begin(), epoch_counters_.end(), 0);
+    std::fill(epoch_vec_counters_.begin(), epoch_vec_counters_.end(), 0);
     for (auto& it : epoch_histo_counts_) {
-        it.second.clear();
+        it.Clear();
     }
     return;
 }
@@ -427,24 +483,26 @@ void SimpleStats::UpdateFinalStats() {
     UpdateCounters();
 
     // update computed stats
-    doubles_["act_energy"] = counters_["num_act_cmds"] * config_.act_energy_inc;
+    doubles_["act_energy"] =
+        Counter("num_act_cmds", false) * config_.act_energy_inc;
     doubles_["read_energy"] =
-        counters_["num_read_cmds"] * config_.read_energy_inc;
+        Counter("num_read_cmds", false) * config_.read_energy_inc;
     doubles_["write_energy"] =
-        counters_["num_write_cmds"] * config_.write_energy_inc;
-    doubles_["ref_energy"] = counters_["num_ref_cmds"] * config_.ref_energy_inc;
+        Counter("num_write_cmds", false) * config_.write_energy_inc;
+    doubles_["ref_energy"] =
+        Counter("num_ref_cmds", false) * config_.ref_energy_inc;
     doubles_["refb_energy"] =
-        counters_["num_refb_cmds"] * config_.refb_energy_inc;
+        Counter("num_refb_cmds", false) * config_.refb_energy_inc;
 
     // vector doubles, update first, then push
     double background_energy = 0.0;
     for (int i = 0; i < config_.ranks; i++) {
-        double act_stb =
-            vec_counters_["rank_active_cycles"][i] * config_.act_stb_energy_inc;
-        double pre_stb = vec_counters_["all_bank_idle_cycles"][i] *
+        double act_stb = VecCounter("rank_active_cycles", i, false) *
+                         config_.act_stb_energy_inc;
+        double pre_stb = VecCounter("all_bank_idle_cycles", i, false) *
                          config_.pre_stb_energy_inc;
         double sref_energy =
-            vec_counters_["sref_cycles"][i] * config_.sref_energy_inc;
+            VecCounter("sref_cycles", i, false) * config_.sref_energy_inc;
         vec_doubles_["act_stb_energy"][i] = act_stb;
         vec_doubles_["pre_stb_energy"][i] = pre_stb;
         vec_doubles_["sref_energy"][i] = sref_energy;
@@ -456,8 +514,8 @@ void SimpleStats::UpdateFinalStats() {
 
     // calculated stats
     uint64_t total_reqs =
-        counters_["num_reads_done"] + counters_["num_writes_done"];
-    double total_time = counters_["num_cycles"] * config_.tCK;
+        Counter("num_reads_done", false) + Counter("num_writes_done", false);
+    double total_time = Counter("num_cycles", false) * config_.tCK;
     double avg_bw = total_reqs * config_.request_size_bytes / total_time;
     calculated_["average_bandwidth"] = avg_bw;
 
@@ -465,12 +523,12 @@ void SimpleStats::UpdateFinalStats() {
                           doubles_["write_energy"] + doubles_["ref_energy"] +
                           doubles_["refb_energy"] + background_energy;
     calculated_["total_energy"] = total_energy;
-    calculated_["average_power"] = total_energy / counters_["num_cycles"];
+    calculated_["average_power"] = total_energy / Counter("num_cycles", false);
     // calculated_["average_read_latency"] = GetHistoAvg("read_latency");
     calculated_["average_read_latency"] =
-        GetHistoAvg(histo_counts_.at("read_latency"));
+        histo_counts_[HistoId("read_latency")].Mean();
     calculated_["average_interarrival"] =
-        GetHistoAvg(histo_counts_.at("interarrival_latency"));
+        histo_counts_[HistoId("interarrival_latency")].Mean();
 
     UpdatePrints(false);
     return;
@@ -8,33 +8,63 @@
 
 #include "configuration.h"
 #include "json.hpp"
+#include "log_histogram.h"
+#include "stats_sink.h"
 
 namespace dramsim3 {
 
 class SimpleStats {
    public:
     SimpleStats(const Config& config, int channel_id);
+
+    // Handles of the registered stats: look a name up once, then updating
+    // through the handle is a single array access
+    int CounterId(const std::string& name) const;
+    int VecCounterId(const std::string& name) const;
+    int HistoId(const std::string& name) const;
+
     // incrementing counter
-    void Increment(const std::string name) { epoch_counters_[name] += 1; }
+    void Increment(int id) { epoch_counters_[id] += 1; }
+    void Increment(const std::string& name) { Increment(CounterId(name)); }
+
+    // increment counter by number
+    void IncrementBy(int id, uint64_t num) { epoch_counters_[id] += num; }
+    void IncrementBy(const std::string& name, uint64_t num) {
+        IncrementBy(CounterId(name), num);
+    }
 
     // incrementing for vec counter
-    void IncrementVec(const std::string name, int pos) {
-        epoch_vec_counters_[name][pos] += 1;
+    void IncrementVec(int id, int pos) { epoch_vec_counters_[id + pos] += 1; }
+    void IncrementVec(const std::string& name, int pos) {
+        IncrementVec(VecCounterId(name), pos);
     }
 
     // increment vec counter by number
-    void IncrementVecBy(const std::string name, int pos, int num) {
-        epoch_vec_counters_[name][pos] += num;
+    void IncrementVecBy(int id, int pos, uint64_t num) {
+        epoch_vec_counters_[id + pos] += num;
+    }
+    void IncrementVecBy(const std::string& name, int pos, uint64_t num) {
+        IncrementVecBy(VecCounterId(name), pos, num);
     }
 
     // add historgram value
-    void AddValue(const std::string name, const int value);
+    void AddValue(int id, const int value) {
+        epoch_histo_counts_[id].Add(value < 0 ? 0 : value);
+    }
+    void AddValue(const std::string& name, const int value) {
+        AddValue(HistoId(name), value);
+    }
 
     // return per rank background energy
     double RankBackgroundEnergy(const int r) const;
 
-    // Epoch update
-    void PrintEpochStats();
+    // Epoch update, the record goes to `sink` unless it is null. A binary
+    // epoch file is the 8 byte magic kEpochMagic followed by records of a
+    // uint8_t type, the uint32_t channel and a uint32_t count n:
+    //   type 0, the fields of the channel's next records: n names, each a
+    //           uint16_t length and the characters
+    //   type 1, an epoch: n doubles, one per field
+    void PrintEpochStats(StatsSink* sink);
 
     // Final statas output
     void PrintFinalStats();
@@ -61,6 +91,7 @@ class SimpleStats {
     void UpdatePrints(bool epoch);
     std::string GetTextHeader(bool is_final) const;
     void UpdateEpochStats();
+    void PutBinaryEpoch(StatsSink& sink);
     void UpdateFinalStats();
 
     const Config& config_;
@@ -69,13 +100,23 @@ class SimpleStats {
     // map names to descriptions
     std::unordered_map<std::string, std::string> header_descs_;
 
-    // counter stats, indexed by their name
-    std::unordered_map<std::string, uint64_t> counters_;
-    std::unordered_map<std::string, uint64_t> epoch_counters_;
+    // counter stats, indexed by their handle
+    std::unordered_map<std::string, int> counter_ids_;
+    std::vector<uint64_t> counters_;
+    std::vector<uint64_t> epoch_counters_;
+    uint64_t Counter(const std::string& name, bool epoch) const {
+        return (epoch ? epoch_counters_ : counters_)[CounterId(name)];
+    }
 
-    // vectored counter stats, first indexed by name then by index
-    VecStat vec_counters_;
-    VecStat epoch_vec_counters_;
+    // vectored counter stats back to back, a handle is the offset of the
+    // first element, the name maps to (offset, length)
+    std::unordered_map<std::string, std::pair<int, int> > vec_counter_ids_;
+    std::vector<uint64_t> vec_counters_;
+    std::vector<uint64_t> epoch_vec_counters_;
+    uint64_t VecCounter(const std::string& name, int pos, bool epoch) const {
+        const auto& counters = epoch ? epoch_vec_counters_ : vec_counters_;
+        return counters[VecCounterId(name) + pos];
+    }
 
     // NOTE: doubles_ vec_doubles_ and calculated_ are basically one time
     // placeholders after each epoch they store the value for that epoch
@@ -92,15 +133,21 @@ class SimpleStats {
 
     std::unordered_map<std::string, std::pair<int, int> > histo_bounds_;
     std::unordered_map<std::string, int> bin_widths_;
-    std::unordered_map<std::string, HistoCount> histo_counts_;
-    std::unordered_map<std::string, HistoCount> epoch_histo_counts_;
+    std::unordered_map<std::string, int> histo_ids_;
+    // exact over the bounds of the stat, log-bucketed beyond them
+    std::vector<LogHistogram> histo_counts_;
+    std::vector<LogHistogram> epoch_histo_counts_;
     VecStat histo_bins_;
     VecStat epoch_histo_bins_;
 
     // outputs
     Json j_data_;
     std::vector<std::pair<std::string, std::string> > print_pairs_;
+    // fields of the last binary epoch record
+    std::vector<std::string> epoch_fields_;
 };
 
+extern const char kEpochMagic[8];
+
 }  // namespace dramsim3
 #endif
\ No newline at end of file
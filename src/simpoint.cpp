@@ -0,0 +1,202 @@
+#include "simpoint.h"
+#include <math.h>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <utility>
+
+namespace dramsim3 {
+
+namespace {
+
+double Distance(const std::vector<double>& a, const std::vector<double>& b) {
+    double d = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        d += (a[i] - b[i]) * (a[i] - b[i]);
+    }
+    return d;
+}
+
+}  // namespace
+
+std::vector<double> WindowSignature::Features(uint64_t max_pages) const {
+    std::vector<double> f;
+    double total = std::accumulate(accesses.begin(), accesses.end(), 0.0);
+    for (uint32_t a : accesses) {
+        f.push_back(total > 0 ? a / total : 0);
+    }
+    total = std::accumulate(footprint.begin(), footprint.end(), 0.0);
+    for (uint32_t p : footprint) {
+        f.push_back(total > 0 ? p / total : 0);
+    }
+    f.push_back(r_num + w_num > 0 ? 1.0 * w_num / (r_num + w_num) : 0);
+    f.push_back(max_pages > 0 ? 1.0 * pages / max_pages : 0);
+    return f;
+}
+
+std::ostream& operator<<(std::ostream& os, const WindowSignature& tmp) {
+    os << tmp.sid << " " << tmp.eid << " " << tmp.pages << " " << tmp.r_num
+       << " " << tmp.w_num << " " << tmp.accesses.size();
+    for (uint32_t a : tmp.accesses) os << " " << a;
+    for (uint32_t p : tmp.footprint) os << " " << p;
+    os << "\n";
+    return os;
+}
+
+std::istream& operator>>(std::istream& is, WindowSignature& tmp) {
+    uint64_t dims = 0;
+    is >> tmp.sid >> tmp.eid >> tmp.pages >> tmp.r_num >> tmp.w_num >> dims;
+    tmp.accesses.resize(dims);
+    tmp.footprint.resize(dims);
+    for (auto& a : tmp.accesses) is >> a;
+    for (auto& p : tmp.footprint) is >> p;
+    return is;
+}
+
+std::ostream& operator<<(std::ostream& os, const SimPoint& tmp) {
+    os << tmp.sid << " " << tmp.eid << " " << tmp.weight << " " << tmp.cluster
+       << "\n";
+    return os;
+}
+
+std::istream& operator>>(std::istream& is, SimPoint& tmp) {
+    is >> tmp.sid >> tmp.eid >> tmp.weight >> tmp.cluster;
+    return is;
+}
+
+KMeans::KMeans(const std::vector<std::vector<double>>& points, int k,
+               uint64_t seed, int max_iterations)
+    : points_(points), labels_(points.size(), 0) {
+    size_t n = points.size();
+    if (n == 0) return;
+    std::mt19937_64 gen(seed);
+
+    // k-means++: next centroid drawn proportionally to squared distance
+    centroids_.push_back(points[gen() % n]);
+    std::vector<double> dist(n, std::numeric_limits<double>::max());
+    while (centroids_.size() < static_cast<size_t>(k)) {
+        double total = 0;
+        for (size_t i = 0; i < n; i++) {
+            dist[i] = std::min(dist[i], Distance(points[i], centroids_.back()));
+            total += dist[i];
+        }
+        if (total == 0) break;
+        double r = std::uniform_real_distribution<double>(0, total)(gen);
+        size_t i = 0;
+        for (; i + 1 < n; i++) {
+            r -= dist[i];
+            if (r <= 0) break;
+        }
+        centroids_.push_back(points[i]);
+    }
+
+    for (int it = 0; it < max_iterations; it++) {
+        bool changed = false;
+        for (size_t i = 0; i < n; i++) {
+            int best = 0;
+            double best_d = Distance(points[i], centroids_[0]);
+            for (size_t c = 1; c < centroids_.size(); c++) {
+                double d = Distance(points[i], centroids_[c]);
+                if (d < best_d) {
+                    best = c;
+                    best_d = d;
+                }
+            }
+            if (best != labels_[i]) {
+                labels_[i] = best;
+                changed = true;
+            }
+        }
+        if (!changed && it > 0) break;
+
+        // an emptied cluster keeps its old centroid
+        std::vector<std::vector<double>> sum(
+            centroids_.size(), std::vector<double>(points[0].size(), 0));
+        std::vector<uint64_t> count(centroids_.size(), 0);
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j < points[i].size(); j++) {
+                sum[labels_[i]][j] += points[i][j];
+            }
+            count[labels_[i]]++;
+        }
+        for (size_t c = 0; c < centroids_.size(); c++) {
+            if (count[c] == 0) continue;
+            for (size_t j = 0; j < sum[c].size(); j++) {
+                centroids_[c][j] = sum[c][j] / count[c];
+            }
+        }
+    }
+}
+
+double KMeans::BIC() const {
+    double r = points_.size();
+    double k = centroids_.size();
+    if (r <= k) {
+        return -std::numeric_limits<double>::max();
+    }
+    double d = points_[0].size();
+    std::vector<double> count(centroids_.size(), 0);
+    double sq = 0;
+    for (size_t i = 0; i < points_.size(); i++) {
+        sq += Distance(points_[i], centroids_[labels_[i]]);
+        count[labels_[i]]++;
+    }
+    double variance = std::max(sq / (r - k), 1e-12);
+
+    double likelihood = 0;
+    for (double rc : count) {
+        if (rc == 0) continue;
+        likelihood += rc * log(rc) - rc * log(r) - rc / 2 * log(2 * M_PI) -
+                      rc * d / 2 * log(variance) - (rc - k) / 2;
+    }
+    double params = (k - 1) + k * d + 1;
+    return likelihood - params / 2 * log(r);
+}
+
+void SampledStats::Add(const SimPoint& point, const std::vector<double>& values) {
+    samples_.push_back(Sample{point.cluster, point.weight, values});
+}
+
+void SampledStats::Print(std::ostream& os) const {
+    if (samples_.empty()) return;
+    std::vector<Sample> s = samples_;
+    std::sort(s.begin(), s.end(), [](const Sample& a, const Sample& b) {
+        return a.cluster < b.cluster;
+    });
+    double total = 0;
+    for (auto& i : s) total += i.weight;
+
+    // pair clusters 0-1, 2-3, ...; an odd last cluster pairs with the one
+    // before it
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (size_t i = 0; i + 1 < s.size(); i += 2) {
+        pairs.push_back(std::make_pair(i, i + 1));
+    }
+    if (s.size() > 1 && s.size() % 2 == 1) {
+        pairs.push_back(std::make_pair(s.size() - 2, s.size() - 1));
+    }
+
+    os << std::dec << "sampled " << s.size() << " windows covering "
+       << total * 100 << " % of the trace\n";
+    for (size_t j = 0; j < names_.size(); j++) {
+        double mean = 0;
+        for (auto& i : s) mean += i.weight / total * i.values[j];
+        double variance = 0;
+        for (auto& p : pairs) {
+            const Sample& a = s[p.first];
+            const Sample& b = s[p.second];
+            double w = (a.weight + b.weight) / total / 2;
+            variance += w * w * pow(a.values[j] - b.values[j], 2);
+        }
+        os << "estimated " << names_[j] << ": " << mean;
+        if (s.size() > 1) {
+            double err = 2 * sqrt(variance);
+            os << " +- " << err << " (" << (mean != 0 ? err / fabs(mean) * 100 : 0)
+               << " %)";
+        }
+        os << "\n";
+    }
+}
+
+}  // namespace dramsim3
@@ -0,0 +1,81 @@
+#ifndef DRAMSIM3_SIMPOINT_H
+#define DRAMSIM3_SIMPOINT_H
+#include <iostream>
+#include <string>
+#include <vector>
+#include "common.h"
+
+namespace dramsim3 {
+
+// Signature of one trace window (.sig), written by trace_profile:
+//   sid eid pages r_num w_num dims accesses[dims] footprint[dims]
+// accesses and footprint count accesses and distinct physical pages per
+// page hash bucket.
+class WindowSignature {
+   public:
+    uint64_t sid;
+    uint64_t eid;
+    uint64_t pages;
+    uint64_t r_num;
+    uint64_t w_num;
+    std::vector<uint32_t> accesses;
+    std::vector<uint32_t> footprint;
+
+    // both vectors normalized to a distribution, then the write fraction
+    // and the footprint relative to `max_pages`
+    std::vector<double> Features(uint64_t max_pages) const;
+    friend std::ostream& operator<<(std::ostream& os, const WindowSignature& tmp);
+    friend std::istream& operator>>(std::istream& is, WindowSignature& tmp);
+};
+
+// Representative window of a cluster (.simpt): sid eid weight cluster.
+// weight is the fraction of windows in the cluster.
+class SimPoint {
+   public:
+    uint64_t sid;
+    uint64_t eid;
+    double weight;
+    int cluster;
+    friend std::ostream& operator<<(std::ostream& os, const SimPoint& tmp);
+    friend std::istream& operator>>(std::istream& is, SimPoint& tmp);
+};
+
+// k-means with k-means++ seeding
+class KMeans {
+   public:
+    KMeans(const std::vector<std::vector<double>>& points, int k, uint64_t seed,
+           int max_iterations = 100);
+    const std::vector<int>& Labels() const { return labels_; }
+    const std::vector<std::vector<double>>& Centroids() const { return centroids_; }
+    // Bayesian information criterion of the clustering under a spherical
+    // Gaussian model, as used by SimPoint to pick k
+    double BIC() const;
+
+   private:
+    const std::vector<std::vector<double>>& points_;
+    std::vector<int> labels_;
+    std::vector<std::vector<double>> centroids_;
+};
+
+// Stats estimated from one simulated window per cluster. Each value is the
+// weighted mean over the samples; its error is the collapsed strata
+// estimate, pairing clusters in cluster order, which is conservative.
+class SampledStats {
+   public:
+    explicit SampledStats(const std::vector<std::string>& names) : names_(names) {}
+    void Add(const SimPoint& point, const std::vector<double>& values);
+    bool Empty() const { return samples_.empty(); }
+    void Print(std::ostream& os) const;
+
+   private:
+    struct Sample {
+        int cluster;
+        double weight;
+        std::vector<double> values;
+    };
+    std::vector<std::string> names_;
+    std::vector<Sample> samples_;
+};
+
+}  // namespace dramsim3
+#endif  // DRAMSIM3_SIMPOINT_H
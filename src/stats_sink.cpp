@@ -0,0 +1,71 @@
+#include "stats_sink.h"
+#include <iostream>
+
+namespace dramsim3 {
+
+namespace {
+// buffers waiting for the writer before Flush() blocks
+const size_t kMaxPending = 4;
+}  // namespace
+
+StatsSink::StatsSink(size_t buffer_size)
+    : buffer_size_(buffer_size), fp_(NULL), closing_(false) {}
+
+StatsSink::~StatsSink() { Close(); }
+
+bool StatsSink::Open(const std::string &path) {
+    Close();
+    fp_ = fopen(path.c_str(), "wb");
+    if (fp_ == NULL) {
+        std::cerr << "cannot create " << path << std::endl;
+        return false;
+    }
+    closing_ = false;
+    writer_ = std::thread(&StatsSink::Run, this);
+    return true;
+}
+
+void StatsSink::Flush() {
+    std::string data = buffer_.str();
+    buffer_.str(std::string());
+    if (data.empty() || fp_ == NULL) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    room_.wait(lock, [this] { return pending_.size() < kMaxPending; });
+    pending_.push_back(std::move(data));
+    ready_.notify_one();
+}
+
+void StatsSink::Close() {
+    if (fp_ == NULL) {
+        return;
+    }
+    Flush();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closing_ = true;
+    }
+    ready_.notify_one();
+    writer_.join();
+    fclose(fp_);
+    fp_ = NULL;
+}
+
+void StatsSink::Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        ready_.wait(lock, [this] { return !pending_.empty() || closing_; });
+        if (pending_.empty()) {
+            return;
+        }
+        std::string data = std::move(pending_.front());
+        pending_.pop_front();
+        room_.notify_one();
+        lock.unlock();
+        fwrite(data.data(), 1, data.size(), fp_);
+        lock.lock();
+    }
+}
+
+}  // namespace dramsim3
@@ -0,0 +1,67 @@
+#ifndef DRAMSIM3_STATS_SINK_H
+#define DRAMSIM3_STATS_SINK_H
+#include <stdio.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+namespace dramsim3 {
+
+// Output file written by a background thread. Records are formatted into
+// an in-memory buffer, a full buffer is handed to the writer thread and
+// written with one fwrite, so the simulation never waits on the file
+// system unless the writer falls several buffers behind. The bytes are
+// the same as streaming into an std::ofstream.
+class StatsSink {
+   public:
+    explicit StatsSink(size_t buffer_size = 1 << 20);
+    ~StatsSink();
+    // truncates `path`
+    bool Open(const std::string &path);
+    // writes everything buffered and closes the file
+    void Close();
+    bool IsOpen() const { return fp_ != NULL; }
+
+    template <typename T>
+    StatsSink &operator<<(const T &v) {
+        buffer_ << v;
+        CheckBuffer();
+        return *this;
+    }
+    void Write(const void *data, size_t len) {
+        buffer_.write(static_cast<const char *>(data), len);
+        CheckBuffer();
+    }
+    template <typename T>
+    void Put(const T &v) {
+        static_assert(std::is_trivially_copyable<T>::value, "raw copy only");
+        Write(&v, sizeof(T));
+    }
+    // hands the buffer to the writer thread
+    void Flush();
+
+   private:
+    void CheckBuffer() {
+        if (static_cast<size_t>(buffer_.tellp()) >= buffer_size_) Flush();
+    }
+    void Run();
+
+    size_t buffer_size_;
+    FILE *fp_;
+    std::ostringstream buffer_;
+    std::thread writer_;
+    std::mutex mutex_;
+    // the writer waits for buffers, Flush() for room and Close() for the
+    // writer to finish
+    std::condition_variable ready_;
+    std::condition_variable room_;
+    std::deque<std::string> pending_;
+    bool closing_;
+};
+
+}  // namespace dramsim3
+#endif  // DRAMSIM3_STATS_SINK_H
@@ -0,0 +1,64 @@
+#include "tick_pool.h"
+
+namespace dramsim3 {
+
+namespace {
+// spins before a waiting thread starts yielding its core
+const int kSpins = 4096;
+}  // namespace
+
+TickPool::TickPool(int threads)
+    : fn_(nullptr), n_(0), generation_(0), pending_(0), stop_(false) {
+    for (int i = 1; i < threads; i++) {
+        workers_.emplace_back(&TickPool::Work, this, i);
+    }
+}
+
+TickPool::~TickPool() {
+    stop_.store(true, std::memory_order_relaxed);
+    generation_.fetch_add(1, std::memory_order_release);
+    for (auto &w : workers_) {
+        w.join();
+    }
+}
+
+void TickPool::Share(int id) {
+    for (size_t i = id; i < n_; i += Threads()) {
+        (*fn_)(i);
+    }
+}
+
+void TickPool::Run(size_t n, const std::function<void(size_t)> &fn) {
+    if (workers_.empty()) {
+        for (size_t i = 0; i < n; i++) fn(i);
+        return;
+    }
+    fn_ = &fn;
+    n_ = n;
+    pending_.store(static_cast<int>(workers_.size()), std::memory_order_relaxed);
+    generation_.fetch_add(1, std::memory_order_release);
+    Share(0);
+    for (int spins = 0; pending_.load(std::memory_order_acquire) != 0; spins++) {
+        if (spins > kSpins) std::this_thread::yield();
+    }
+}
+
+void TickPool::Work(int id) {
+    uint64_t seen = 0;
+    while (true) {
+        uint64_t generation;
+        for (int spins = 0;
+             (generation = generation_.load(std::memory_order_acquire)) == seen;
+             spins++) {
+            if (spins > kSpins) std::this_thread::yield();
+        }
+        seen = generation;
+        if (stop_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        Share(id);
+        pending_.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+}  // namespace dramsim3
@@ -0,0 +1,37 @@
+#ifndef DRAMSIM3_TICK_POOL_H
+#define DRAMSIM3_TICK_POOL_H
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace dramsim3 {
+
+// Runs fn(0..n-1) across a fixed set of threads, the calling thread
+// included, and returns once every call finished. Task i always runs on
+// thread i % Threads(), so per-task state never moves between threads.
+// Meant for work of a few microseconds per round (one DRAM clock of every
+// channel): idle workers spin on a generation counter instead of sleeping
+// on a condition variable, and yield when a round takes long to come.
+class TickPool {
+   public:
+    explicit TickPool(int threads);
+    ~TickPool();
+    int Threads() const { return static_cast<int>(workers_.size()) + 1; }
+    void Run(size_t n, const std::function<void(size_t)> &fn);
+
+   private:
+    void Work(int id);
+    void Share(int id);
+
+    std::vector<std::thread> workers_;
+    const std::function<void(size_t)> *fn_;
+    size_t n_;
+    // bumped to start a round, workers still running it
+    std::atomic<uint64_t> generation_;
+    std::atomic<int> pending_;
+    std::atomic<bool> stop_;
+};
+
+}  // namespace dramsim3
+#endif  // DRAMSIM3_TICK_POOL_H
@@ -1,26 +1,86 @@
 #ifndef TRACE_H
 #define TRACE_H
-#include <map>
+#include <stdio.h>
+#include "common.h"
+#include "mapped_file.h"
+#include "page_table.h"
 struct record_t {
     unsigned int rw;
     int pid;
-    unsigned long tm; 
+    unsigned long tm;
     unsigned long paddr;
     unsigned long long vaddr;
 };
-int trace_init(const char *tracefile, const char *ktfile);
-void trace_finish();
-int next_translate();
-extern struct record_t record;
-extern unsigned long *next_page_map;
-extern unsigned long *prev_page_map;
-extern std::map<unsigned long, unsigned long> vpn2ppn;
-extern unsigned long *ppn2vpn;
-extern int addr_type;
-extern unsigned long *alloc_stamp;
-extern unsigned long long  total_trace;
-extern unsigned long long  nonpte;
-extern unsigned long long trace_id;
-extern unsigned long long miss_free_pte;
-extern unsigned long long skip_set_pt_pmd;
+
+namespace dramsim3 {
+
+// Decoder of one HMTT .trace/.kt pair: replays the kernel page-table tags
+// to translate physical trace records to (pid, vaddr). All state lives in
+// the object, so any number of readers can be open in one process.
+class TraceReader {
+   public:
+    TraceReader();
+    ~TraceReader();
+    int Init(const char *tracefile, const char *ktfile, bool use_mmap = true);
+    void Finish();
+    bool IsOpen() const { return tracefile.IsOpen(); }
+
+    // next translated record, 0 at the end of the trace
+    int NextTranslate();
+    const record_t &Record() const { return record; }
+    // next transaction of processes [ppid, ppid + num_p) or of the kernel
+    void NextHMTT(HMTTTransaction &trans, int ppid, uint64_t num_p);
+
+    // snapshot of the translation state, see TraceIndex
+    int SaveState(FILE *fp) const;
+    int LoadState(FILE *fp);
+
+    // trace time of the last transaction returned by NextHMTT
+    uint64_t Clock() const { return last_clk; }
+    void SetClock(uint64_t clk) { last_clk = clk; }
+    uint64_t Translated() const { return translated_trace; }
+    uint64_t NonPTE() const { return nonpte; }
+    void ResetNonPTE() { nonpte = 0; }
+    // memory held by the translation tables
+    uint64_t ResidentBytes() const;
+
+   private:
+    int NextRecord();
+    int ReadKT();
+    void SetPTE(int pid, uint64_t val);
+
+    MappedFile tracefile;
+    MappedFile ktfile;
+    record_t record;
+    char kt_ch[16];
+    uint64_t last_clk;
+
+    uint64_t tagp;
+    uint64_t tag_size;
+    uint64_t has_read;
+    int tag_end;
+    uint64_t tag_cnt;
+    uint64_t duration_all;
+
+    uint64_t total_trace;
+    uint64_t trace_id;
+    uint64_t translated_trace;
+    uint64_t nonpte;
+    uint64_t set_pte_cnt;
+    uint64_t free_pte_cnt;
+    uint64_t free_pte_num;
+    uint64_t miss_set_pte;
+    uint64_t miss_free_pte;
+    uint64_t skip_free_pte;
+    int topmc_tag;
+
+    RadixTable<unsigned long> ppn2vpn;
+    RadixTable<int> ppn2pid;
+    RadixTable<unsigned long> next_page_map;
+    RadixTable<unsigned long> prev_page_map;
+    RadixTable<unsigned long> alloc_stamp;
+    PageHashMap vpn2ppn;
+};
+
+}  // namespace dramsim3
 #endif
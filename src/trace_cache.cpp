@@ -0,0 +1,186 @@
+#include "trace_cache.h"
+#include <string.h>
+#include <iostream>
+
+namespace dramsim3 {
+
+const uint32_t TraceCacheReader::kVersion;
+const uint32_t TraceCacheReader::kBlockRecords;
+const char TraceCacheReader::kMagic[8] = {'H', 'M', 'T', 'T', 'C', 'A', 'C', 'H'};
+
+static const uint32_t kWideDelta = ~0u;
+
+TraceCacheWriter::TraceCacheWriter() : fp_(NULL) {
+    memset(&header_, 0, sizeof(header_));
+}
+
+TraceCacheWriter::~TraceCacheWriter() { Close(); }
+
+bool TraceCacheWriter::Open(const std::string &path, int ppid, uint64_t num_p,
+                            uint64_t trace_size, uint64_t kt_size) {
+    fp_ = fopen(path.c_str(), "wb");
+    if (fp_ == NULL) {
+        return false;
+    }
+    memset(&header_, 0, sizeof(header_));
+    memcpy(header_.magic, TraceCacheReader::kMagic, sizeof(header_.magic));
+    header_.version = TraceCacheReader::kVersion;
+    header_.block_records = TraceCacheReader::kBlockRecords;
+    header_.trace_size = trace_size;
+    header_.kt_size = kt_size;
+    header_.ppid = ppid;
+    header_.num_p = num_p;
+    // rewritten with the final counts in Close()
+    fwrite(&header_, sizeof(header_), 1, fp_);
+    return true;
+}
+
+void TraceCacheWriter::Append(uint64_t delta_ns, uint64_t addr, uint64_t vaddr,
+                              int pid, bool r_w, bool is_kernel) {
+    if (delta_ns >= kWideDelta) {
+        delta_.push_back(kWideDelta);
+        wide_.push_back(delta_ns);
+    } else {
+        delta_.push_back(static_cast<uint32_t>(delta_ns));
+    }
+    blk_.push_back(static_cast<uint32_t>(addr >> 6));
+    vaddr_.push_back(vaddr);
+    pid_.push_back(pid);
+    flags_.push_back((r_w ? 1 : 0) | (is_kernel ? 2 : 0));
+    header_.num_records++;
+    if (delta_.size() == header_.block_records) {
+        FlushBlock();
+    }
+}
+
+void TraceCacheWriter::FlushBlock() {
+    if (delta_.empty()) {
+        return;
+    }
+    offsets_.push_back(ftello(fp_));
+    uint32_t count = delta_.size();
+    uint32_t num_wide = wide_.size();
+    fwrite(&count, sizeof(count), 1, fp_);
+    fwrite(&num_wide, sizeof(num_wide), 1, fp_);
+    fwrite(delta_.data(), sizeof(uint32_t), count, fp_);
+    fwrite(blk_.data(), sizeof(uint32_t), count, fp_);
+    fwrite(vaddr_.data(), sizeof(uint64_t), count, fp_);
+    fwrite(pid_.data(), sizeof(int32_t), count, fp_);
+    fwrite(flags_.data(), sizeof(uint8_t), count, fp_);
+    fwrite(wide_.data(), sizeof(uint64_t), num_wide, fp_);
+    delta_.clear();
+    blk_.clear();
+    vaddr_.clear();
+    pid_.clear();
+    flags_.clear();
+    wide_.clear();
+}
+
+void TraceCacheWriter::Close() {
+    if (fp_ == NULL) {
+        return;
+    }
+    FlushBlock();
+    header_.num_blocks = offsets_.size();
+    header_.index_offset = ftello(fp_);
+    fwrite(offsets_.data(), sizeof(uint64_t), offsets_.size(), fp_);
+    fseeko(fp_, 0, SEEK_SET);
+    fwrite(&header_, sizeof(header_), 1, fp_);
+    fclose(fp_);
+    fp_ = NULL;
+}
+
+TraceCacheReader::TraceCacheReader()
+    : block_(0), block_start_(0), pos_(0), pending_ns_(0), wide_pos_(0) {
+    memset(&header_, 0, sizeof(header_));
+}
+
+bool TraceCacheReader::Open(const std::string &path) {
+    if (!file_.Open(path.c_str()) ||
+        file_.Read(&header_, sizeof(header_)) != sizeof(header_)) {
+        std::cerr << "cannot read trace cache " << path << std::endl;
+        return false;
+    }
+    if (memcmp(header_.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header_.version != kVersion) {
+        std::cerr << path << " is not a version " << kVersion
+                  << " trace cache" << std::endl;
+        return false;
+    }
+    offsets_.resize(header_.num_blocks);
+    file_.Seek(header_.index_offset);
+    size_t len = offsets_.size() * sizeof(uint64_t);
+    if (file_.Read(offsets_.data(), len) != len) {
+        std::cerr << "truncated trace cache " << path << std::endl;
+        return false;
+    }
+    pending_ns_ = 0;
+    return Seek(0);
+}
+
+void TraceCacheReader::Close() { file_.Close(); }
+
+bool TraceCacheReader::LoadBlock(uint64_t block) {
+    block_ = block;
+    block_start_ = block * header_.block_records;
+    pos_ = 0;
+    wide_pos_ = 0;
+    delta_.clear();
+    if (block >= header_.num_blocks) {
+        return false;
+    }
+    file_.Seek(offsets_[block]);
+    uint32_t count = 0, num_wide = 0;
+    file_.Read(&count, sizeof(count));
+    file_.Read(&num_wide, sizeof(num_wide));
+    delta_.resize(count);
+    blk_.resize(count);
+    vaddr_.resize(count);
+    pid_.resize(count);
+    flags_.resize(count);
+    wide_.resize(num_wide);
+    file_.Read(delta_.data(), sizeof(uint32_t) * count);
+    file_.Read(blk_.data(), sizeof(uint32_t) * count);
+    file_.Read(vaddr_.data(), sizeof(uint64_t) * count);
+    file_.Read(pid_.data(), sizeof(int32_t) * count);
+    file_.Read(flags_.data(), sizeof(uint8_t) * count);
+    file_.Read(wide_.data(), sizeof(uint64_t) * num_wide);
+    return true;
+}
+
+bool TraceCacheReader::Seek(uint64_t record) {
+    if (record > header_.num_records) {
+        return false;
+    }
+    LoadBlock(record / header_.block_records);
+    pos_ = record % header_.block_records;
+    for (uint32_t i = 0; i < pos_; i++) {
+        if (delta_[i] == kWideDelta) wide_pos_++;
+    }
+    pending_ns_ = 0;
+    return true;
+}
+
+void TraceCacheReader::Next(HMTTTransaction &trans, int ppid, uint64_t num_p) {
+    do {
+        if (pos_ == delta_.size() && !LoadBlock(block_ + 1)) {
+            trans.valid = false;
+            return;
+        }
+        uint32_t i = pos_++;
+        pending_ns_ +=
+            delta_[i] == kWideDelta ? wide_[wide_pos_++] : delta_[i];
+        trans.valid = true;
+        trans.addr = static_cast<uint64_t>(blk_[i]) << 6;
+        trans.r_w = flags_[i] & 1;
+        trans.is_kernel = (flags_[i] & 2) != 0;
+        trans.vaddr = vaddr_[i];
+        trans.pid = pid_[i];
+    } while ((trans.pid < ppid ||
+              trans.pid >= static_cast<int>(ppid + num_p)) &&
+             !trans.is_kernel);
+    trans.added_ns = pending_ns_;
+    pending_ns_ = 0;
+}
+
+}  // namespace dramsim3
@@ -0,0 +1,95 @@
+#ifndef DRAMSIM3_TRACE_CACHE_H
+#define DRAMSIM3_TRACE_CACHE_H
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "common.h"
+#include "mapped_file.h"
+
+namespace dramsim3 {
+
+// Pre-translated HMTT trace (.htc). NextTranslate() output is stored in
+// blocks of kBlockRecords records, each block column-wise:
+//   uint32 delta_ns[]  ns since the previous stored record, ~0u -> wide[]
+//   uint32 blk[]       paddr >> 6
+//   uint64 vaddr[]
+//   int32  pid[]
+//   uint8  flags[]     bit0 r_w, bit1 is_kernel
+//   uint64 wide[]      overflowed deltas, in order
+// followed by a table of block offsets. The header records the pid filter
+// applied at conversion time (num_p == 0 keeps every record).
+struct TraceCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t block_records;
+    uint64_t num_records;
+    uint64_t num_blocks;
+    uint64_t index_offset;
+    uint64_t trace_size;
+    uint64_t kt_size;
+    int32_t ppid;
+    uint32_t reserved;
+    uint64_t num_p;
+};
+
+class TraceCacheWriter {
+   public:
+    TraceCacheWriter();
+    ~TraceCacheWriter();
+    bool Open(const std::string &path, int ppid, uint64_t num_p,
+              uint64_t trace_size, uint64_t kt_size);
+    void Append(uint64_t delta_ns, uint64_t addr, uint64_t vaddr, int pid,
+                bool r_w, bool is_kernel);
+    void Close();
+    uint64_t NumRecords() const { return header_.num_records; }
+
+   private:
+    void FlushBlock();
+
+    FILE *fp_;
+    TraceCacheHeader header_;
+    std::vector<uint64_t> offsets_;
+    std::vector<uint32_t> delta_;
+    std::vector<uint32_t> blk_;
+    std::vector<uint64_t> vaddr_;
+    std::vector<int32_t> pid_;
+    std::vector<uint8_t> flags_;
+    std::vector<uint64_t> wide_;
+};
+
+class TraceCacheReader {
+   public:
+    TraceCacheReader();
+    bool Open(const std::string &path);
+    void Close();
+    // same contract as TraceReader::NextHMTT(), trans.valid is false at the end
+    void Next(HMTTTransaction &trans, int ppid, uint64_t num_p);
+    bool Seek(uint64_t record);
+    uint64_t Position() const { return block_start_ + pos_; }
+    const TraceCacheHeader &Header() const { return header_; }
+
+    static const uint32_t kVersion = 1;
+    static const uint32_t kBlockRecords = 1 << 16;
+    static const char kMagic[8];
+
+   private:
+    bool LoadBlock(uint64_t block);
+
+    MappedFile file_;
+    TraceCacheHeader header_;
+    std::vector<uint64_t> offsets_;
+    uint64_t block_;
+    uint64_t block_start_;
+    uint32_t pos_;
+    uint64_t pending_ns_;
+    std::vector<uint32_t> delta_;
+    std::vector<uint32_t> blk_;
+    std::vector<uint64_t> vaddr_;
+    std::vector<int32_t> pid_;
+    std::vector<uint8_t> flags_;
+    std::vector<uint64_t> wide_;
+    uint32_t wide_pos_;
+};
+
+}  // namespace dramsim3
+#endif  // DRAMSIM3_TRACE_CACHE_H
@@ -0,0 +1,119 @@
+#include "trace_index.h"
+#include <string.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <iostream>
+
+namespace dramsim3 {
+
+const uint32_t TraceIndex::kVersion;
+const char TraceIndex::kMagic[8] = {'H', 'M', 'T', 'T', 'I', 'D', 'X', '\0'};
+
+static uint64_t FileSize(const std::string &path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? st.st_size : 0;
+}
+
+TraceIndex::TraceIndex() : fp_(NULL) { memset(&header_, 0, sizeof(header_)); }
+
+TraceIndex::~TraceIndex() { Close(); }
+
+void TraceIndex::Close() {
+    if (fp_ != NULL) {
+        fclose(fp_);
+        fp_ = NULL;
+    }
+    entries_.clear();
+}
+
+bool TraceIndex::Open(const std::string &path) {
+    fp_ = fopen(path.c_str(), "rb");
+    if (fp_ == NULL) {
+        std::cerr << "cannot open trace index " << path << std::endl;
+        return false;
+    }
+    if (fread(&header_, sizeof(header_), 1, fp_) != 1 ||
+        memcmp(header_.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header_.version != kVersion) {
+        std::cerr << path << " is not a version " << kVersion
+                  << " trace index" << std::endl;
+        Close();
+        return false;
+    }
+    entries_.resize(header_.num_entries);
+    fseeko(fp_, header_.table_offset, SEEK_SET);
+    if (fread(entries_.data(), sizeof(TraceIndexEntry), entries_.size(), fp_) !=
+        entries_.size()) {
+        std::cerr << "truncated trace index " << path << std::endl;
+        Close();
+        return false;
+    }
+    return true;
+}
+
+const TraceIndexEntry *TraceIndex::Find(uint64_t id) const {
+    auto it = std::upper_bound(
+        entries_.begin(), entries_.end(), id,
+        [](uint64_t v, const TraceIndexEntry &e) { return v < e.id; });
+    if (it == entries_.begin()) {
+        return NULL;
+    }
+    return &*(it - 1);
+}
+
+bool TraceIndex::Restore(TraceReader &reader, const TraceIndexEntry &entry) {
+    if (fseeko(fp_, entry.offset, SEEK_SET) != 0 ||
+        reader.LoadState(fp_) != 0) {
+        std::cerr << "corrupted snapshot at trace id " << entry.id << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool TraceIndex::Build(const std::string &trace_file, const std::string &path,
+                       int ppid, uint64_t num_p, uint64_t interval) {
+    FILE *fp = fopen(path.c_str(), "wb");
+    if (fp == NULL) {
+        std::cerr << "cannot create " << path << std::endl;
+        return false;
+    }
+    TraceIndexHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.ppid = ppid;
+    header.num_p = num_p;
+    header.interval = interval;
+    header.trace_size = FileSize(trace_file + ".trace");
+    header.kt_size = FileSize(trace_file + ".kt");
+    fwrite(&header, sizeof(header), 1, fp);
+
+    TraceReader reader;
+    reader.Init((trace_file + ".trace").c_str(), (trace_file + ".kt").c_str());
+    std::vector<TraceIndexEntry> entries;
+    HMTTTransaction trans;
+    uint64_t id = 0;
+    do {
+        if (id % interval == 0) {
+            TraceIndexEntry e = {id, reader.Translated(),
+                                 static_cast<uint64_t>(ftello(fp))};
+            reader.SaveState(fp);
+            entries.push_back(e);
+            std::cout << std::dec << "snapshot at " << id << "\n";
+        }
+        reader.NextHMTT(trans, ppid, num_p);
+        id++;
+    } while (trans.valid);
+    reader.Finish();
+
+    header.num_entries = entries.size();
+    header.table_offset = ftello(fp);
+    fwrite(entries.data(), sizeof(TraceIndexEntry), entries.size(), fp);
+    fseeko(fp, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, fp);
+    bool ok = ferror(fp) == 0;
+    fclose(fp);
+    return ok;
+}
+
+}  // namespace dramsim3
@@ -0,0 +1,60 @@
+#ifndef DRAMSIM3_TRACE_INDEX_H
+#define DRAMSIM3_TRACE_INDEX_H
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "trace.h"
+
+namespace dramsim3 {
+
+// Sparse index over an HMTT trace (.hti). Every `interval` NextHMTT ids
+// it stores a snapshot of the translation state (file offsets, kernel tag
+// position, page tables) so a reader can jump to any trace id and decode
+// at most `interval` records instead of the whole prefix. Ids count the
+// transactions returned for the ppid/num_p filter recorded in the header.
+struct TraceIndexHeader {
+    char magic[8];
+    uint32_t version;
+    int32_t ppid;
+    uint64_t num_p;
+    uint64_t interval;
+    uint64_t num_entries;
+    uint64_t table_offset;
+    uint64_t trace_size;
+    uint64_t kt_size;
+};
+
+struct TraceIndexEntry {
+    uint64_t id;
+    uint64_t translated;  // NextTranslate() records consumed up to id
+    uint64_t offset;
+};
+
+class TraceIndex {
+   public:
+    TraceIndex();
+    ~TraceIndex();
+    bool Open(const std::string &path);
+    void Close();
+    bool IsOpen() const { return fp_ != NULL; }
+    // last snapshot at or before id, NULL if there is none
+    const TraceIndexEntry *Find(uint64_t id) const;
+    // restore an initialized reader to the snapshot
+    bool Restore(TraceReader &reader, const TraceIndexEntry &entry);
+    const TraceIndexHeader &Header() const { return header_; }
+    const std::vector<TraceIndexEntry> &Entries() const { return entries_; }
+
+    static bool Build(const std::string &trace_file, const std::string &path,
+                      int ppid, uint64_t num_p, uint64_t interval);
+
+    static const uint32_t kVersion = 3;
+    static const char kMagic[8];
+
+   private:
+    FILE *fp_;
+    TraceIndexHeader header_;
+    std::vector<TraceIndexEntry> entries_;
+};
+
+}  // namespace dramsim3
+#endif  // DRAMSIM3_TRACE_INDEX_H
@@ -0,0 +1,85 @@
+#include "trace_prefetcher.h"
+#include <chrono>
+
+namespace dramsim3 {
+
+TracePrefetcher::TracePrefetcher(Source source, size_t batch_size,
+                                 size_t num_batches)
+    : source_(source),
+      batch_size_(batch_size),
+      ring_(num_batches, std::vector<HMTTTransaction>(batch_size)),
+      count_(num_batches, 0),
+      head_(0),
+      tail_(0),
+      stop_(false),
+      pos_(0),
+      end_(false) {
+    last_.valid = false;
+}
+
+TracePrefetcher::~TracePrefetcher() { Stop(); }
+
+void TracePrefetcher::Start() {
+    if (IsRunning()) {
+        return;
+    }
+    head_.store(0);
+    tail_.store(0);
+    stop_.store(false);
+    pos_ = 0;
+    end_ = false;
+    worker_ = std::thread(&TracePrefetcher::Run, this);
+}
+
+void TracePrefetcher::Stop() {
+    if (!IsRunning()) {
+        return;
+    }
+    stop_.store(true);
+    worker_.join();
+}
+
+void TracePrefetcher::Run() {
+    const uint64_t num_batches = ring_.size();
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    bool valid = true;
+    while (valid && !stop_.load(std::memory_order_relaxed)) {
+        if (head - tail_.load(std::memory_order_acquire) == num_batches) {
+            // the ring is full, the consumer needs a while to drain a batch
+            std::this_thread::sleep_for(std::chrono::microseconds(20));
+            continue;
+        }
+        std::vector<HMTTTransaction> &batch = ring_[head % num_batches];
+        size_t n = 0;
+        while (n < batch_size_ && valid) {
+            source_(batch[n]);
+            valid = batch[n++].valid;
+        }
+        count_[head % num_batches] = n;
+        head_.store(++head, std::memory_order_release);
+    }
+}
+
+void TracePrefetcher::Next(HMTTTransaction &trans) {
+    if (end_) {
+        trans = last_;
+        return;
+    }
+    const uint64_t num_batches = ring_.size();
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    while (head_.load(std::memory_order_acquire) == tail) {
+        std::this_thread::yield();
+    }
+    size_t slot = tail % num_batches;
+    trans = ring_[slot][pos_++];
+    if (!trans.valid) {
+        end_ = true;
+        last_ = trans;
+    }
+    if (pos_ == count_[slot]) {
+        pos_ = 0;
+        tail_.store(tail + 1, std::memory_order_release);
+    }
+}
+
+}  // namespace dramsim3
@@ -0,0 +1,46 @@
+#ifndef DRAMSIM3_TRACE_PREFETCHER_H
+#define DRAMSIM3_TRACE_PREFETCHER_H
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "common.h"
+
+namespace dramsim3 {
+
+// Decodes transactions on a dedicated thread into a ring of fixed-size
+// batches. One producer (the decode thread) and one consumer (the
+// simulation thread) share the ring through two counters, so no locks are
+// taken on either side.
+class TracePrefetcher {
+   public:
+    typedef std::function<void(HMTTTransaction &)> Source;
+    TracePrefetcher(Source source, size_t batch_size = 4096,
+                    size_t num_batches = 4);
+    ~TracePrefetcher();
+    void Start();
+    // stops decoding, transactions still in the ring are dropped
+    void Stop();
+    bool IsRunning() const { return worker_.joinable(); }
+    // same contract as the source, trans.valid is false at the end
+    void Next(HMTTTransaction &trans);
+
+   private:
+    void Run();
+
+    Source source_;
+    const size_t batch_size_;
+    std::vector<std::vector<HMTTTransaction>> ring_;
+    std::vector<size_t> count_;
+    // batches published by the producer / released by the consumer
+    std::atomic<uint64_t> head_;
+    std::atomic<uint64_t> tail_;
+    std::atomic<bool> stop_;
+    std::thread worker_;
+    size_t pos_;
+    bool end_;
+    HMTTTransaction last_;
+};
+
+}  // namespace dramsim3
+#endif  // DRAMSIM3_TRACE_PREFETCHER_H
@@ -0,0 +1,180 @@
+#include "trace_profile.h"
+#include <algorithm>
+#include <iterator>
+
+namespace dramsim3 {
+
+const uint64_t TraceProfiler::kSegmentGap;
+
+namespace {
+
+// physical pages after the 2GB shift of the reader stay below 2^26
+const uint64_t kMaxPPN = 1ULL << 26;
+
+// Spans of one kind. Every page is stamped with the number of the last span
+// that touched it, so a span's footprint is counted without a page set and
+// nothing has to be cleared when the next span opens.
+template <typename Table>
+class SpanTracker {
+   public:
+    template <typename... Args>
+    SpanTracker(std::vector<ProfileSpan> &spans, uint64_t dims, Args... args)
+        : spans_(spans), dims_(dims), stamp_(args...), epoch_(0) {}
+
+    void Open(uint64_t id, bool joins_prev) {
+        if (epoch_ > 0) Close(false);
+        epoch_++;
+        ProfileSpan s;
+        s.sid = id;
+        s.eid = id;
+        s.time = 0;
+        s.r_num = 0;
+        s.w_num = 0;
+        s.kernel_num = 0;
+        s.pages = 0;
+        s.joins_prev = joins_prev;
+        s.accesses.assign(dims_, 0);
+        s.footprint.assign(dims_, 0);
+        spans_.push_back(s);
+    }
+
+    void Add(uint64_t id, uint64_t page, const HMTTTransaction &trans,
+             uint64_t ns) {
+        ProfileSpan &s = spans_.back();
+        s.eid = id;
+        s.time += ns;
+        s.r_num += trans.r_w;
+        s.w_num += 1 - trans.r_w;
+        s.kernel_num += trans.is_kernel;
+        uint64_t bucket = dims_ > 0 ? HashPage(page) % dims_ : 0;
+        if (dims_ > 0) {
+            s.accesses[bucket]++;
+        }
+        if (stamp_.Get(page) != epoch_) {
+            stamp_.Set(page, epoch_);
+            s.pages++;
+            if (dims_ > 0) {
+                s.footprint[bucket]++;
+            }
+        }
+    }
+
+    // close the last span at the end of the profiled range
+    void Finish() {
+        if (epoch_ > 0) Close(true);
+    }
+
+   private:
+    void Close(bool tail) {
+        ProfileSpan &s = spans_.back();
+        if (!tail && !s.joins_prev) return;
+        uint64_t epoch = epoch_;
+        std::vector<uint64_t> &pages = s.page_list;
+        stamp_.ForEach([epoch, &pages](uint64_t page, uint64_t e) {
+            if (e == epoch) pages.push_back(page);
+        });
+        std::sort(pages.begin(), pages.end());
+    }
+
+    std::vector<ProfileSpan> &spans_;
+    uint64_t dims_;
+    Table stamp_;
+    uint64_t epoch_;
+};
+
+void AppendSpans(std::vector<ProfileSpan> &spans, std::vector<ProfileSpan> &next) {
+    size_t first = spans.size();
+    for (ProfileSpan &s : next) {
+        if (!s.joins_prev || spans.empty()) {
+            spans.push_back(std::move(s));
+            continue;
+        }
+        ProfileSpan &p = spans.back();
+        std::vector<uint64_t> pages;
+        std::set_union(p.page_list.begin(), p.page_list.end(),
+                       s.page_list.begin(), s.page_list.end(),
+                       std::back_inserter(pages));
+        p.eid = s.eid;
+        p.time += s.time;
+        p.r_num += s.r_num;
+        p.w_num += s.w_num;
+        p.kernel_num += s.kernel_num;
+        p.pages = pages.size();
+        p.page_list.swap(pages);
+        for (size_t i = 0; i < p.accesses.size(); i++) {
+            p.accesses[i] += s.accesses[i];
+        }
+        if (!p.footprint.empty()) {
+            // pages seen on both sides count once
+            std::fill(p.footprint.begin(), p.footprint.end(), 0);
+            for (uint64_t page : p.page_list) {
+                p.footprint[HashPage(page) % p.footprint.size()]++;
+            }
+        }
+    }
+    // only the last span can continue into the next profile
+    for (size_t i = first > 0 ? first - 1 : 0; i + 1 < spans.size(); i++) {
+        std::vector<uint64_t>().swap(spans[i].page_list);
+    }
+}
+
+}  // namespace
+
+void TraceProfile::Append(TraceProfile &next) {
+    AppendSpans(segments, next.segments);
+    AppendSpans(windows, next.windows);
+    AppendSpans(periods, next.periods);
+    for (auto &p : next.pid_records) {
+        pid_records[p.first] += p.second;
+    }
+}
+
+TraceProfiler::TraceProfiler(int ppid, uint64_t num_p, uint64_t window,
+                             uint64_t period_ns, uint64_t signature_dims)
+    : ppid_(ppid),
+      num_p_(num_p),
+      window_(window),
+      period_ns_(period_ns),
+      signature_dims_(signature_dims) {}
+
+void TraceProfiler::Run(TraceReader &reader, uint64_t start, uint64_t end,
+                        TraceProfile &profile) const {
+    profile = TraceProfile();
+    SpanTracker<PageHashMap> segments(profile.segments, 0);
+    SpanTracker<RadixTable<uint64_t>> windows(profile.windows, signature_dims_,
+                                              kMaxPPN);
+    SpanTracker<PageHashMap> periods(profile.periods, 0);
+
+    HMTTTransaction trans;
+    uint64_t now = reader.Clock() * 5;
+    for (uint64_t id = start; id < end; id++) {
+        reader.NextHMTT(trans, ppid_, num_p_);
+        if (!trans.valid) break;
+        uint64_t last = now;
+        now += trans.added_ns;
+
+        bool split = id == 0 || trans.added_ns > kSegmentGap;
+        bool new_period = last / period_ns_ != now / period_ns_;
+        if (id == start) {
+            segments.Open(id, !split);
+            windows.Open(id, id % window_ != 0);
+            periods.Open(id, id > 0 && !new_period);
+        } else {
+            if (split) segments.Open(id, false);
+            if (id % window_ == 0) windows.Open(id, false);
+            if (new_period) periods.Open(id, false);
+        }
+
+        segments.Add(id, trans.vaddr >> 12, trans, split ? 0 : trans.added_ns);
+        windows.Add(id, trans.addr >> 12, trans, trans.added_ns);
+        periods.Add(id, trans.vaddr >> 12, trans, trans.added_ns);
+        if (!trans.is_kernel) {
+            profile.pid_records[trans.pid]++;
+        }
+    }
+    segments.Finish();
+    windows.Finish();
+    periods.Finish();
+}
+
+}  // namespace dramsim3
@@ -0,0 +1,68 @@
+#ifndef DRAMSIM3_TRACE_PROFILE_H
+#define DRAMSIM3_TRACE_PROFILE_H
+#include <map>
+#include <vector>
+#include "trace.h"
+
+namespace dramsim3 {
+
+// A run of consecutive trace ids [sid, eid] and what it touched.
+struct ProfileSpan {
+    uint64_t sid;
+    uint64_t eid;
+    uint64_t time;  // ns, without the idle gap that opened a segment
+    uint64_t r_num;
+    uint64_t w_num;
+    uint64_t kernel_num;
+    uint64_t pages;  // distinct pages
+    // the span started before the profiled range and continues the last
+    // span of the previous profile
+    bool joins_prev;
+    // pages of a span cut by the profiled range, kept for the merge
+    std::vector<uint64_t> page_list;
+    // signature of a window, accesses and distinct pages per page hash
+    // bucket; empty unless the profiler was asked for signatures
+    std::vector<uint32_t> accesses;
+    std::vector<uint32_t> footprint;
+
+    uint64_t length() const { return eid - sid + 1; }
+};
+
+// Everything trace_seg and working_size measured, collected in one pass:
+//   segments  split where a transaction follows an idle gap > kSegmentGap,
+//             pages are virtual pages
+//   windows   trace ids [k * window, (k + 1) * window), physical pages
+//   periods   trace time [k * period_ns, (k + 1) * period_ns), virtual pages
+// Windows and periods are aligned to the start of the trace rather than to
+// the segment or the last reset, so profiles of adjacent id ranges can be
+// merged with Append().
+struct TraceProfile {
+    std::vector<ProfileSpan> segments;
+    std::vector<ProfileSpan> windows;
+    std::vector<ProfileSpan> periods;
+    std::map<int, uint64_t> pid_records;  // user transactions per pid
+
+    // merge the profile of the id range that directly follows this one
+    void Append(TraceProfile &next);
+};
+
+class TraceProfiler {
+   public:
+    TraceProfiler(int ppid, uint64_t num_p, uint64_t window, uint64_t period_ns,
+                  uint64_t signature_dims = 0);
+    // profile trace ids [start, end) from a reader positioned at start
+    void Run(TraceReader &reader, uint64_t start, uint64_t end,
+             TraceProfile &profile) const;
+
+    static const uint64_t kSegmentGap = 1000000;
+
+   private:
+    int ppid_;
+    uint64_t num_p_;
+    uint64_t window_;
+    uint64_t period_ns_;
+    uint64_t signature_dims_;
+};
+
+}  // namespace dramsim3
+#endif  // DRAMSIM3_TRACE_PROFILE_H
@@ -0,0 +1,43 @@
+#include "catch.hpp"
+#include "log_histogram.h"
+
+TEST_CASE("Log-linear histogram", "[histogram]") {
+    dramsim3::LogHistogram hist;
+
+    SECTION("Small values are exact") {
+        for (uint64_t i = 1; i <= 100; i++) {
+            hist.Add(i);
+        }
+        REQUIRE(hist.Count() == 100);
+        REQUIRE(hist.Mean() == Approx(50.5));
+        REQUIRE(hist.Percentile(50) == 50);
+        REQUIRE(hist.Percentile(99) == 99);
+        REQUIRE(hist.Percentile(100) == 100);
+        REQUIRE(hist.Max() == 100);
+    }
+
+    SECTION("Large values stay within a bucket") {
+        hist.Add(1000000, 99);
+        hist.Add(123456789);
+        REQUIRE(hist.Percentile(50) >= 1000000);
+        REQUIRE(hist.Percentile(50) <= 1000000 + 1000000 / 128);
+        REQUIRE(hist.Percentile(99.9) == 123456789);
+        REQUIRE(hist.Sum() == 99 * 1000000ULL + 123456789);
+    }
+
+    SECTION("Merge adds counts") {
+        dramsim3::LogHistogram other;
+        hist.Add(10, 3);
+        other.Add(5000, 1);
+        hist.Merge(other);
+        uint64_t buckets = 0;
+        hist.ForEach([&](uint64_t low, uint64_t high, uint64_t count) {
+            REQUIRE(low <= high);
+            buckets += count;
+        });
+        REQUIRE(buckets == 4);
+        REQUIRE(hist.Max() == 5000);
+        hist.Clear();
+        REQUIRE(hist.Empty());
+    }
+}
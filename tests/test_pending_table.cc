@@ -0,0 +1,123 @@
+#include <deque>
+#include <map>
+#include <vector>
+#include "catch.hpp"
+#include "pending_table.h"
+
+using dramsim3::PendingTable;
+using dramsim3::Transaction;
+
+// the first `num` addresses whose home slot is `home` in a table of
+// 2^`bits` slots, same hash as PendingTable::Home()
+static std::vector<uint64_t> AddrsAt(size_t home, int bits, int num) {
+    std::vector<uint64_t> addrs;
+    for (uint64_t addr = 0; static_cast<int>(addrs.size()) < num; addr += 64) {
+        if (((addr * 0x9E3779B97F4A7C15ULL) >> (64 - bits)) == home) {
+            addrs.push_back(addr);
+        }
+    }
+    return addrs;
+}
+
+static Transaction Trans(uint64_t addr, uint64_t cycle) {
+    Transaction trans(addr, false);
+    trans.added_cycle = cycle;
+    return trans;
+}
+
+TEST_CASE("Pending transaction table", "[pending_table]") {
+    // 16 slots
+    PendingTable table(8);
+    Transaction trans;
+
+    SECTION("Colliding addresses wrap around the table end") {
+        auto last = AddrsAt(15, 4, 3);
+        auto first = AddrsAt(0, 4, 1);
+        // slots 15, 0, 1 and 2
+        for (auto addr : last) table.Push(Trans(addr, 0));
+        table.Push(Trans(first[0], 0));
+        for (auto addr : last) REQUIRE(table.Count(addr) == 1);
+        REQUIRE(table.Count(first[0]) == 1);
+
+        // the others shift back across the end
+        REQUIRE(table.Pop(last[0], trans));
+        REQUIRE(trans.addr == last[0]);
+        REQUIRE(table.Count(last[0]) == 0);
+        REQUIRE(table.Count(last[1]) == 1);
+        REQUIRE(table.Count(last[2]) == 1);
+        REQUIRE(table.Front(first[0])->addr == first[0]);
+
+        REQUIRE(table.Pop(first[0], trans));
+        REQUIRE(table.Front(last[1])->addr == last[1]);
+        REQUIRE(table.Front(last[2])->addr == last[2]);
+        REQUIRE(table.Pop(last[2], trans));
+        REQUIRE(table.Pop(last[1], trans));
+        REQUIRE(table.Empty());
+    }
+
+    SECTION("Erase in the middle of a probe run") {
+        auto five = AddrsAt(5, 4, 3);
+        auto six = AddrsAt(6, 4, 1);
+        auto nine = AddrsAt(9, 4, 1);
+        // slots 5 to 9, the entry homed at 9 must not move
+        for (auto addr : five) table.Push(Trans(addr, 0));
+        table.Push(Trans(six[0], 0));
+        table.Push(Trans(nine[0], 0));
+
+        REQUIRE(table.Pop(five[1], trans));
+        REQUIRE(table.Count(five[1]) == 0);
+        REQUIRE(table.Count(five[0]) == 1);
+        REQUIRE(table.Count(five[2]) == 1);
+        REQUIRE(table.Count(six[0]) == 1);
+        REQUIRE(table.Count(nine[0]) == 1);
+
+        table.Push(Trans(five[1], 1));
+        REQUIRE(table.Front(five[1])->added_cycle == 1);
+        REQUIRE(table.Pop(six[0], trans));
+        for (auto addr : five) REQUIRE(table.Count(addr) == 1);
+        REQUIRE(table.Count(nine[0]) == 1);
+    }
+
+    SECTION("Grow keeps every address") {
+        for (uint64_t i = 0; i < 100; i++) {
+            table.Push(Trans(i * 64, i));
+            table.Push(Trans(i * 64, i + 1000));
+        }
+        for (uint64_t i = 0; i < 100; i++) {
+            REQUIRE(table.Count(i * 64) == 2);
+            REQUIRE(table.Front(i * 64)->added_cycle == i);
+        }
+        for (uint64_t i = 0; i < 100; i++) {
+            REQUIRE(table.Pop(i * 64, trans));
+            REQUIRE(table.Pop(i * 64, trans));
+            REQUIRE(trans.added_cycle == i + 1000);
+        }
+        REQUIRE(table.Empty());
+        REQUIRE_FALSE(table.Pop(0, trans));
+    }
+
+    SECTION("Merged reads come out in arrival order") {
+        // nodes freed by other addresses are reused in between
+        uint64_t cycle = 0;
+        std::map<uint64_t, std::deque<uint64_t>> expected;
+        for (int round = 0; round < 50; round++) {
+            for (uint64_t addr = 0; addr < 4 * 64; addr += 64) {
+                table.Push(Trans(addr, cycle));
+                expected[addr].push_back(cycle++);
+            }
+            uint64_t addr = (round % 4) * 64;
+            REQUIRE(table.Pop(addr, trans));
+            REQUIRE(trans.added_cycle == expected[addr].front());
+            expected[addr].pop_front();
+        }
+        for (auto &it : expected) {
+            REQUIRE(table.Count(it.first) == it.second.size());
+            while (!it.second.empty()) {
+                REQUIRE(table.Pop(it.first, trans));
+                REQUIRE(trans.added_cycle == it.second.front());
+                it.second.pop_front();
+            }
+        }
+        REQUIRE(table.Empty());
+    }
+}
@@ -0,0 +1,126 @@
+#include <memory>
+#include <utility>
+#include <vector>
+#include "catch.hpp"
+#include "command_queue.h"
+#include "refresh.h"
+#include "timing.h"
+
+using namespace dramsim3;
+
+// the parts of a controller Refresh works with; a refresh is issued the
+// clock it shows up in the channel state
+struct RefreshBench {
+    RefreshBench(int postpone, int pullin)
+        : config("configs/DDR4_8Gb_x8_3200.ini", "."),
+          timing(config),
+          channel_state(config, timing),
+          stats(config, 0),
+          cmd_queue(0, config, channel_state, stats),
+          clk(0) {
+        config.refresh_postpone = postpone;
+        config.refresh_pullin = pullin;
+        refresh.reset(new Refresh(config, channel_state, cmd_queue));
+        interval = config.tREFI / config.ranks;
+    }
+
+    // a command stays queued for the rank, so the rank is never idle
+    void Busy(int rank) {
+        cmd_queue.AddCommand(
+            Command(CommandType::READ, Address(0, rank, 0, 0, 0, 0), 0));
+    }
+
+    void Tick() {
+        refresh->ClockTick();
+        for (int r = 0; r < config.ranks; r++) {
+            if (channel_state.IsRefreshPending(r)) {
+                issued.emplace_back(clk, r);
+                channel_state.RankNeedRefresh(r, false);
+            }
+        }
+        clk++;
+    }
+
+    void RunTo(uint64_t end) {
+        while (clk < end) Tick();
+    }
+
+    // the k-th clock a refresh of rank 0 falls due
+    uint64_t Due(int k) const { return interval * (1 + k * config.ranks); }
+
+    std::vector<uint64_t> Issued(int rank) const {
+        std::vector<uint64_t> clks;
+        for (const auto& it : issued) {
+            if (it.second == rank) clks.push_back(it.first);
+        }
+        return clks;
+    }
+
+    Config config;
+    Timing timing;
+    ChannelState channel_state;
+    SimpleStats stats;
+    CommandQueue cmd_queue;
+    std::unique_ptr<Refresh> refresh;
+    uint64_t clk;
+    uint64_t interval;
+    std::vector<std::pair<uint64_t, int>> issued;
+};
+
+TEST_CASE("Refresh postponement and pull-in", "[refresh]") {
+    SECTION("A busy rank is refreshed at the postponement limit") {
+        RefreshBench bench(2, 0);
+        bench.Busy(0);
+        bench.RunTo(bench.Due(2));
+        REQUIRE(bench.Issued(0).empty());
+        if (bench.config.ranks > 1) {
+            // idle ranks are not held back
+            REQUIRE(bench.Issued(1) ==
+                    std::vector<uint64_t>({2 * bench.interval,
+                                           bench.Due(1) + bench.interval}));
+        }
+        bench.RunTo(bench.Due(3) + 1);
+        REQUIRE(bench.Issued(0) ==
+                std::vector<uint64_t>({bench.Due(2), bench.Due(3)}));
+    }
+
+    SECTION("Pulled-in refreshes are skipped when they fall due") {
+        RefreshBench bench(0, 2);
+        bench.RunTo(2 * bench.config.ranks);
+        // every unit is polled once a clock, round robin
+        REQUIRE(bench.Issued(0) ==
+                std::vector<uint64_t>(
+                    {0, static_cast<uint64_t>(bench.config.ranks)}));
+        bench.Busy(0);
+        bench.RunTo(bench.Due(2));
+        REQUIRE(bench.Issued(0).size() == 2);
+        bench.RunTo(bench.Due(2) + 1);
+        REQUIRE(bench.Issued(0).size() == 3);
+        REQUIRE(bench.Issued(0).back() == bench.Due(2));
+    }
+
+    SECTION("Fast forward matches ticking") {
+        RefreshBench ticked(2, 2), skipped(2, 2);
+        ticked.Busy(0);
+        skipped.Busy(0);
+        uint64_t end = ticked.Due(8);
+        ticked.RunTo(end);
+
+        int ticks = 0;
+        while (skipped.clk < end) {
+            uint64_t next = skipped.refresh->NextRefreshCycle();
+            if (next > skipped.clk) {
+                uint64_t cycles = std::min(next, end) - skipped.clk;
+                skipped.refresh->FastForward(cycles);
+                skipped.clk += cycles;
+            } else {
+                skipped.Tick();
+                ticks++;
+            }
+        }
+        REQUIRE(ticks < static_cast<int>(end / 100));
+        REQUIRE(skipped.issued == ticked.issued);
+        REQUIRE(skipped.refresh->NextRefreshCycle() ==
+                ticked.refresh->NextRefreshCycle());
+    }
+}
@@ -0,0 +1,81 @@
+#include "catch.hpp"
+#include "reorder_buffer.h"
+
+using dramsim3::HMTTTransaction;
+using dramsim3::ReorderBuffer;
+
+static HMTTTransaction Trans(uint64_t seq_no, uint64_t addr, bool read) {
+    HMTTTransaction trans = HMTTTransaction();
+    trans.seq_no = seq_no;
+    trans.addr = addr;
+    trans.r_w = read ? 1 : 0;
+    trans.valid = true;
+    return trans;
+}
+
+TEST_CASE("HMTT reorder buffer", "[reorder_buffer]") {
+    ReorderBuffer rob(4);
+
+    SECTION("Ring wraps around and grows in order") {
+        // move head to the middle of the ring
+        for (uint64_t i = 0; i < 3; i++) {
+            rob.Push(Trans(i, i * 64, true));
+            rob.Issue();
+            rob.Front().is_finished = true;
+            rob.Retire();
+        }
+        REQUIRE(rob.Empty());
+
+        // entries 3 to 6 wrap around the end of the 4-entry ring, it
+        // doubles on the next push and twice more after that
+        for (uint64_t i = 3; i < 20; i++) {
+            rob.Push(Trans(i, i * 64, true));
+        }
+        REQUIRE(rob.Size() == 17);
+        for (uint64_t i = 3; i < 10; i++) {
+            REQUIRE(rob.Waiting().seq_no == i);
+            rob.Issue();
+        }
+        REQUIRE(rob.FindIssuedRead(5 * 64)->seq_no == 5);
+        REQUIRE(rob.FindIssuedRead(12 * 64) == nullptr);
+
+        // completion out of order, retirement in order
+        rob.FindIssuedRead(4 * 64)->is_finished = true;
+        rob.Retire();
+        REQUIRE(rob.Front().seq_no == 3);
+        rob.FindIssuedRead(3 * 64)->is_finished = true;
+        rob.Retire();
+        REQUIRE(rob.Front().seq_no == 5);
+        REQUIRE(rob.FindIssuedRead(4 * 64) == nullptr);
+        REQUIRE(rob.Size() == 15);
+    }
+
+    SECTION("Oldest issued read of an address is found first") {
+        rob.Push(Trans(0, 0x40, false));
+        rob.Push(Trans(1, 0x40, true));
+        rob.Push(Trans(2, 0x80, true));
+        rob.Push(Trans(3, 0x40, true));
+        rob.Push(Trans(4, 0x40, true));
+
+        rob.Issue();
+        REQUIRE(rob.WaitingDepends());
+        // a write is never matched by a read completion
+        REQUIRE(rob.FindIssuedRead(0x40) == nullptr);
+        for (int i = 0; i < 3; i++) {
+            rob.Issue();
+        }
+        REQUIRE(rob.WaitingDepends());
+        REQUIRE(rob.FindIssuedRead(0x40)->seq_no == 1);
+
+        // the write and the first read retire, the next read is matched
+        rob.Front().is_finished = true;
+        rob.FindIssuedRead(0x40)->is_finished = true;
+        rob.Retire();
+        REQUIRE(rob.Front().seq_no == 2);
+        REQUIRE(rob.FindIssuedRead(0x40)->seq_no == 3);
+        REQUIRE(rob.FindIssuedRead(0x80)->seq_no == 2);
+        rob.Clear();
+        REQUIRE(rob.Empty());
+        REQUIRE(rob.FindIssuedRead(0x40) == nullptr);
+    }
+}
@@ -0,0 +1,31 @@
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include "catch.hpp"
+#include "stats_sink.h"
+
+TEST_CASE("Background stats writer", "[stats_sink]") {
+    const std::string path = "test_stats_sink.out";
+    std::ostringstream expected;
+
+    SECTION("Output matches a stream across many flushes") {
+        // a tiny buffer makes nearly every write a hand-off
+        dramsim3::StatsSink sink(16);
+        REQUIRE(sink.Open(path));
+        for (int i = 0; i < 10000; i++) {
+            sink << i << "\t" << i * 0.5 << "\n";
+            expected << i << "\t" << i * 0.5 << "\n";
+        }
+        uint32_t raw = 0xdeadbeef;
+        sink.Put(raw);
+        expected.write(reinterpret_cast<const char*>(&raw), sizeof(raw));
+        sink.Close();
+        REQUIRE_FALSE(sink.IsOpen());
+
+        std::ifstream file(path, std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(file)),
+                             std::istreambuf_iterator<char>());
+        REQUIRE(contents == expected.str());
+    }
+    remove(path.c_str());
+}
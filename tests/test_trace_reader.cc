@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "catch.hpp"
+#include "trace.h"
+#include "trace_prefetcher.h"
+
+using dramsim3::HMTTTransaction;
+using dramsim3::TracePrefetcher;
+using dramsim3::TraceReader;
+
+// address of kernel tag `tag` in the synthetic trace, see trace.cpp
+static uint64_t KernelTag(int tag) { return 0x64c000000ULL + tag * 4096ULL; }
+
+// a 6 byte HMTT record, the reader moves addresses above 2GB up by 2GB
+static void PutRecord(std::string& trace, uint64_t paddr, int rw, int timer) {
+    if (paddr >= (4ULL << 30)) paddr -= 2ULL << 30;
+    uint64_t raw = (paddr >> 6) | (static_cast<uint64_t>(rw) << 31) |
+                   (static_cast<uint64_t>(timer) << 32);
+    for (int i = 0; i < 6; i++) {
+        trace.push_back(static_cast<char>(raw >> (i * 8)));
+    }
+}
+
+// a 13 byte kernel trace entry mapping (or unmapping) ppn
+static void PutEntry(std::string& kt, char magic, int pid, uint64_t vpn,
+                     uint64_t ppn) {
+    uint64_t val = (vpn << 24) | ppn;
+    kt.push_back(magic);
+    kt.append(reinterpret_cast<const char*>(&pid), sizeof(pid));
+    kt.append(reinterpret_cast<const char*>(&val), sizeof(val));
+}
+
+static void PutMarker(std::string& kt, char c) {
+    kt.append(13, c);
+    kt.append(3, '\0');
+}
+
+// pages 0x10 and 0x20 of processes 1000 and 1001, 0x30 of process 1005 and
+// the unmapped 0x40. Page 0x21 of 1001 is mapped and 0x10 freed midway.
+static void WriteTrace(const std::string& trace_path,
+                       const std::string& kt_path) {
+    std::string trace, kt;
+    PutMarker(kt, '@');
+    PutMarker(kt, '#');
+    PutEntry(kt, static_cast<char>(0xec), 1000, 0x100, 0x10);
+    PutEntry(kt, static_cast<char>(0xec), 1001, 0x200, 0x20);
+    PutEntry(kt, static_cast<char>(0xec), 1005, 0x300, 0x30);
+    PutMarker(kt, '&');
+    PutEntry(kt, static_cast<char>(0xec), 1001, 0x201, 0x21);
+    PutEntry(kt, static_cast<char>(0xfc), 0, 0, 0x10);
+    kt.append(64, '\0');
+
+    const uint64_t pages[] = {0x10, 0x20, 0x30, 0x40, 0x21};
+    PutRecord(trace, KernelTag(2), 1, 1);
+    for (int i = 0; i < 3000; i++) {
+        if (i == 1000) PutRecord(trace, KernelTag(0), 1, 3);
+        if (i == 2000) PutRecord(trace, KernelTag(1), 1, 3);
+        if (i == 1500) PutRecord(trace, 0, 0, 0);
+        uint64_t ppn = pages[i % (i < 1000 ? 4 : 5)];
+        PutRecord(trace, (ppn << 12) | ((i * 64) & 0xfff), i % 3 == 0,
+                  1 + i % 200);
+    }
+
+    std::ofstream(trace_path, std::ios::binary) << trace;
+    std::ofstream(kt_path, std::ios::binary) << kt;
+}
+
+static void RequireSame(const HMTTTransaction& a, const HMTTTransaction& b) {
+    REQUIRE(a.valid == b.valid);
+    REQUIRE(a.addr == b.addr);
+    REQUIRE(a.r_w == b.r_w);
+    REQUIRE(a.pid == b.pid);
+    REQUIRE(a.vaddr == b.vaddr);
+    REQUIRE(a.is_kernel == b.is_kernel);
+    REQUIRE(a.added_ns == b.added_ns);
+}
+
+TEST_CASE("HMTT trace decoding", "[trace]") {
+    const std::string trace_path = "test_trace_reader.trace";
+    const std::string kt_path = "test_trace_reader.kt";
+    WriteTrace(trace_path, kt_path);
+
+    // processes 1000 and 1001 and the kernel
+    std::vector<HMTTTransaction> direct;
+    HMTTTransaction trans = HMTTTransaction();
+    TraceReader reader;
+    reader.Init(trace_path.c_str(), kt_path.c_str());
+    do {
+        reader.NextHMTT(trans, 1000, 2);
+        direct.push_back(trans);
+    } while (trans.valid);
+    reader.Finish();
+
+    SECTION("Records are translated and filtered") {
+        // 1005 is dropped, 0x40 and the freed 0x10 belong to the kernel
+        REQUIRE(direct.size() == 3000 - 250 - 400 + 1);
+        REQUIRE(direct[0].pid == 1000);
+        REQUIRE(direct[0].vaddr == (0x100ULL << 12));
+        // the page table dump tag took 1 cycle at 200MHz
+        REQUIRE(direct[0].added_ns == 10);
+        REQUIRE(direct[1].pid == 1001);
+        REQUIRE(direct[1].vaddr == ((0x200ULL << 12) | 64));
+        REQUIRE(direct[2].is_kernel);
+        int freed = 0, new_page = 0;
+        for (const auto& t : direct) {
+            if (!t.valid) break;
+            REQUIRE((t.is_kernel || t.pid == 1000 || t.pid == 1001));
+            if (t.is_kernel && (t.addr >> 12) == 0x10) freed++;
+            if (t.vaddr >> 12 == 0x201) new_page++;
+        }
+        REQUIRE(freed == 200);
+        REQUIRE(new_page == 400);
+    }
+
+    SECTION("Prefetched transactions match the reader") {
+        TraceReader source;
+        source.Init(trace_path.c_str(), kt_path.c_str());
+        TracePrefetcher prefetcher(
+            [&source](HMTTTransaction& t) { source.NextHMTT(t, 1000, 2); },
+            16, 4);
+        prefetcher.Start();
+        for (const auto& t : direct) {
+            prefetcher.Next(trans);
+            RequireSame(trans, t);
+        }
+        // the end is sticky
+        prefetcher.Next(trans);
+        REQUIRE_FALSE(trans.valid);
+        prefetcher.Stop();
+        source.Finish();
+    }
+
+    SECTION("Stop and Start around a seek") {
+        TraceReader source;
+        source.Init(trace_path.c_str(), kt_path.c_str());
+        TracePrefetcher prefetcher(
+            [&source](HMTTTransaction& t) { source.NextHMTT(t, 1000, 2); },
+            16, 4);
+        const size_t seek_to = 700;
+        for (size_t i = 0; i < seek_to; i++) {
+            source.NextHMTT(trans, 1000, 2);
+            RequireSame(trans, direct[i]);
+        }
+        FILE* state = tmpfile();
+        REQUIRE(source.SaveState(state) == 0);
+
+        // run ahead across the page table updates, Stop drops the ring
+        // and leaves the reader somewhere past the consumer
+        prefetcher.Start();
+        for (size_t i = seek_to; i < 2000; i++) {
+            prefetcher.Next(trans);
+            RequireSame(trans, direct[i]);
+        }
+        prefetcher.Stop();
+        REQUIRE_FALSE(prefetcher.IsRunning());
+
+        rewind(state);
+        REQUIRE(source.LoadState(state) == 0);
+        fclose(state);
+        prefetcher.Start();
+        for (size_t i = seek_to; i < direct.size(); i++) {
+            prefetcher.Next(trans);
+            RequireSame(trans, direct[i]);
+        }
+        prefetcher.Stop();
+        source.Finish();
+    }
+
+    remove(trace_path.c_str());
+    remove(kt_path.c_str());
+}
@@ -0,0 +1,101 @@
+#include "./../ext/headers/args.hxx"
+#include "../src/controller.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+
+using namespace dramsim3;
+
+int main(int argc, const char **argv) {
+    args::ArgumentParser parser(
+        "Cycles per second of one DRAM channel controller fed a random "
+        "address stream, one transaction per cycle while its queues accept.",
+        "Examples: \n."
+        "./build/controller_bench configs/DDR4_8Gb_x8_3200.ini -c 2000000 -w 30\n");
+    args::HelpFlag help(parser, "help", "Display the help menu", {'h', "help"});
+    args::ValueFlag<uint64_t> cycles_arg(parser, "cycles", "Cycles to simulate",
+                                         {'c', "cycles"}, 2000000);
+    args::ValueFlag<uint64_t> addresses_arg(parser, "addresses",
+                                            "Distinct cache lines accessed",
+                                            {'a', "addresses"}, 1 << 20);
+    args::ValueFlag<int> write_arg(parser, "writes", "Percentage of writes",
+                                   {'w', "writes"}, 30);
+    args::ValueFlag<uint64_t> seed_arg(parser, "seed", "Seed of the stream",
+                                       {"seed"}, 1);
+    args::Positional<std::string> config_arg(parser, "config",
+                                             "The config file name (mandatory)");
+
+    try {
+        parser.ParseCLI(argc, argv);
+    } catch (args::Help) {
+        std::cout << parser;
+        return 0;
+    } catch (args::ParseError e) {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+
+    std::string config_file = args::get(config_arg);
+    uint64_t addresses = args::get(addresses_arg);
+    if (config_file.empty() || addresses == 0) {
+        std::cerr << parser;
+        return 1;
+    }
+    uint64_t cycles = args::get(cycles_arg);
+    int writes = args::get(write_arg);
+
+    Config config(config_file, ".");
+    Timing timing(config);
+#ifdef THERMAL
+    ThermalCalculator thermal_calc(config);
+    Controller ctrl(0, config, timing, thermal_calc);
+#else
+    Controller ctrl(0, config, timing);
+#endif  // THERMAL
+
+    std::mt19937_64 gen(args::get(seed_arg));
+    // like a CPU, no write is sent while a read of its address is in
+    // flight (the controller cannot drain such a write)
+    std::unordered_map<uint64_t, int> reading;
+    auto next = [&](uint64_t &addr, bool &is_write) {
+        addr = (gen() % addresses) * config.request_size_bytes;
+        is_write = static_cast<int>(gen() % 100) < writes &&
+                   reading.count(addr) == 0;
+    };
+    uint64_t added = 0, done = 0, checksum = 0;
+    uint64_t addr;
+    bool is_write;
+    next(addr, is_write);
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t clk = 0; clk < cycles; clk++) {
+        while (true) {
+            auto pair = ctrl.ReturnDoneTrans(clk);
+            if (pair.second == -1) break;
+            checksum = checksum * 31 + pair.first + clk;
+            done++;
+            if (pair.second == 0 && --reading[pair.first] == 0) {
+                reading.erase(pair.first);
+            }
+        }
+        if (ctrl.WillAcceptTransaction(addr, is_write)) {
+            Transaction trans(addr, is_write);
+            ctrl.AddTransaction(trans);
+            added++;
+            if (!is_write) reading[addr]++;
+            next(addr, is_write);
+        }
+        ctrl.ClockTick();
+    }
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+            .count();
+    std::cout << "transactions added:    " << added << "\n"
+              << "transactions returned: " << done << "\n"
+              << "return checksum:       " << std::hex << checksum << std::dec
+              << "\n"
+              << "cycles/s:              " << cycles / seconds << "\n"
+              << "transactions/s:        " << added / seconds << "\n";
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include "./../ext/headers/args.hxx"
+#include "../src/simple_stats.h"
+#include <stdio.h>
+#include <string.h>
+#include <iostream>
+#include <map>
+
+using namespace dramsim3;
+
+namespace {
+
+template <typename T>
+bool Get(FILE *fp, T &v) {
+    return fread(&v, sizeof(T), 1, fp) == 1;
+}
+
+}  // namespace
+
+int main(int argc, const char **argv) {
+    args::ArgumentParser parser(
+        "Prints a binary epoch stats file (epoch_format = binary) as JSON "
+        "lines, one record per channel and epoch.",
+        "Examples: \n."
+        "./build/epoch_dump output/dramsim3epoch.bin\n");
+    args::HelpFlag help(parser, "help", "Display the help menu", {'h', "help"});
+    args::Positional<std::string> input_arg(parser, "input",
+                                            "Binary epoch stats file");
+
+    try {
+        parser.ParseCLI(argc, argv);
+    } catch (args::Help) {
+        std::cout << parser;
+        return 0;
+    } catch (args::ParseError e) {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+
+    std::string input = args::get(input_arg);
+    FILE *fp = fopen(input.c_str(), "rb");
+    if (fp == NULL) {
+        std::cerr << "cannot open " << input << std::endl;
+        return 1;
+    }
+    char magic[sizeof(kEpochMagic)];
+    if (fread(magic, 1, sizeof(magic), fp) != sizeof(magic) ||
+        memcmp(magic, kEpochMagic, sizeof(magic)) != 0) {
+        std::cerr << input << " is not a binary epoch stats file" << std::endl;
+        return 1;
+    }
+
+    // fields of each channel's records
+    std::map<uint32_t, std::vector<std::string>> fields;
+    uint8_t type;
+    uint32_t channel, n;
+    while (Get(fp, type) && Get(fp, channel) && Get(fp, n)) {
+        if (type == 0) {
+            auto &names = fields[channel];
+            names.resize(n);
+            for (auto &name : names) {
+                uint16_t len = 0;
+                Get(fp, len);
+                name.resize(len);
+                if (fread(&name[0], 1, len, fp) != len) break;
+            }
+        } else if (type == 1) {
+            std::vector<double> values(n);
+            if (fread(values.data(), sizeof(double), n, fp) != n ||
+                fields[channel].size() != n) {
+                std::cerr << "epoch record of channel " << channel
+                          << " without matching fields" << std::endl;
+                return 1;
+            }
+            nlohmann::json record;
+            for (uint32_t i = 0; i < n; i++) {
+                record[fields[channel][i]] = values[i];
+            }
+            std::cout << record << "\n";
+        } else {
+            std::cerr << "unknown record type " << static_cast<int>(type)
+                      << std::endl;
+            return 1;
+        }
+    }
+    fclose(fp);
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include "./../ext/headers/args.hxx"
+#include "../src/miss_ratio.h"
+#include "../src/trace_index.h"
+#include "../src/cadcache.h"
+#include <iomanip>
+
+using namespace dramsim3;
+
+int main(int argc, const char **argv){
+    args::ArgumentParser parser(
+        "Predict miss ratio curves of the memory pool cache from one pass "
+        "over an HMTT segment.",
+        "Examples: \n."
+        "./build/miss_ratio /mnt/hmtt/ligra_bfs 1000 -p 2 -s 20000000 -e 30000000 \n"
+        "./build/miss_ratio /mnt/hmtt/ligra_bfs 1000 -p 2 -g 1024 -r 0.001 "
+        "--index /mnt/hmtt/ligra_bfs.hti\n");
+    args::HelpFlag help(parser, "help", "Display the help menu", {'h', "help"});
+    args::ValueFlag<uint64_t> num_process_arg(parser, "number_of_process",
+                                              "The number of process to profile",
+                                              {'p'}, 16);
+    args::ValueFlag<uint64_t> start_arg(parser, "start",
+                                        "First trace id of the segment",
+                                        {'s'}, 0);
+    args::ValueFlag<uint64_t> end_arg(parser, "end",
+                                      "Trace id after the segment, 0 runs to the end",
+                                      {'e'}, 0);
+    args::ValueFlagList<uint64_t> granularity_arg(parser, "granularity",
+                                                  "Extra cache line size (B), besides 256 and 4096",
+                                                  {'g'});
+    args::ValueFlag<double> rate_arg(parser, "rate",
+                                     "Fraction of blocks sampled",
+                                     {'r'}, 0.01);
+    args::ValueFlag<std::string> bench_arg(parser, "benchmark",
+                                           "Benchmark whose footprint the Ratio column uses, "
+                                           "the trace name by default",
+                                           {'b'}, "");
+    args::ValueFlag<std::string> index_arg(parser, "index",
+                                           "Seekable trace index (.hti) built by trace_index",
+                                           {"index"});
+    args::Positional<std::string> trace_arg(
+        parser, "trace", "The trace file name (mandatory)");
+    args::Positional<int> pid_arg(
+        parser, "pid", "The pid of parent process (mandatory)");
+
+    try {
+        parser.ParseCLI(argc, argv);
+    } catch (args::Help) {
+        std::cout << parser;
+        return 0;
+    } catch (args::ParseError e) {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+
+    std::string trace_file = args::get(trace_arg);
+    double rate = args::get(rate_arg);
+    if (trace_file.empty() || rate <= 0 || rate > 1) {
+        std::cerr << parser;
+        return 1;
+    }
+    for (uint64_t g : args::get(granularity_arg)) {
+        if (g == 0) {
+            std::cerr << "granularity must be positive" << std::endl;
+            std::cerr << parser;
+            return 1;
+        }
+    }
+    int ppid = args::get(pid_arg);
+    uint64_t process = args::get(num_process_arg);
+    uint64_t start = args::get(start_arg);
+    uint64_t end = args::get(end_arg) == 0 ? UINT64_MAX : args::get(end_arg);
+
+    std::string bench = args::get(bench_arg);
+    if (bench.empty()) {
+        bench = trace_file.substr(trace_file.find_last_of('/') + 1);
+    }
+    uint64_t footprint = BenchmarkInfo.count(bench) ? BenchmarkInfo.at(bench) : 0;
+
+    std::vector<StackDistance> profiles;
+    profiles.emplace_back(StackDistance(256, rate));
+    profiles.emplace_back(StackDistance(4096, rate));
+    for (uint64_t g : args::get(granularity_arg)) {
+        if (g != 256 && g != 4096) {
+            profiles.emplace_back(StackDistance(g, rate));
+        }
+    }
+
+    TraceReader reader;
+    reader.Init((trace_file+".trace").c_str(), (trace_file+".kt").c_str());
+    uint64_t id = 0;
+    TraceIndex index;
+    if (index_arg) {
+        if (!index.Open(args::get(index_arg))) {
+            AbruptExit(__FILE__, __LINE__);
+        }
+        const TraceIndexEntry *e = index.Find(start);
+        if (e != nullptr && e->id > 0 &&
+            index.Header().ppid == ppid && index.Header().num_p == process) {
+            if (!index.Restore(reader, *e)) {
+                AbruptExit(__FILE__, __LINE__);
+            }
+            id = e->id;
+        }
+    }
+
+    // only application traffic goes through the memory pool cache
+    HMTTTransaction tmp;
+    for (; id < end; id++) {
+        reader.NextHMTT(tmp, ppid, process);
+        if (!tmp.valid) {
+            break;
+        }
+        if (id < start || tmp.is_kernel) {
+            continue;
+        }
+        for (auto &p : profiles) {
+            p.Access(tmp.addr);
+        }
+    }
+    reader.Finish();
+
+    for (auto &p : profiles) {
+        std::cout<<std::dec<<"# "<<p.BlockSize()<<" B lines, "
+                 <<p.Sampled()<<" of "<<p.Accesses()<<" accesses sampled, "
+                 <<p.Cold()<<" cold, ~"<<p.Blocks()<<" blocks\n";
+        std::cout<<"#"<<std::setw(14)<<"lines"
+                 <<std::setw(15)<<"bytes"
+                 <<std::setw(15)<<"ratio"
+                 <<std::setw(15)<<"direct"
+                 <<std::setw(15)<<"4-way"
+                 <<std::setw(15)<<"fully\n";
+        for (uint64_t lines = 4; lines / 2 <= p.Blocks(); lines *= 2) {
+            std::cout<<std::setw(15)<<lines
+                     <<std::setw(15)<<lines * p.BlockSize();
+            if (footprint != 0) {
+                std::cout<<std::setw(15)<<std::setprecision(4)
+                         <<1.0 * lines * p.BlockSize() / footprint;
+            } else {
+                std::cout<<std::setw(15)<<"-";
+            }
+            std::cout<<std::fixed<<std::setprecision(4)
+                     <<std::setw(15)<<p.MissRatio(lines, 1)
+                     <<std::setw(15)<<p.MissRatio(lines, 4)
+                     <<std::setw(15)<<p.MissRatio(lines, 0)
+                     <<"\n"<<std::defaultfloat;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,163 @@
+#include "./../ext/headers/args.hxx"
+#include "../src/reorder_buffer.h"
+#include <chrono>
+#include <iostream>
+#include <list>
+#include <queue>
+#include <random>
+
+using namespace dramsim3;
+
+namespace {
+
+// the std::list ROB HMTTCPU used before ReorderBuffer, every dependency
+// check and completion scans the list
+class ListROB {
+   public:
+    ListROB() : wait(rob.end()) {}
+    bool Empty() const { return rob.empty(); }
+    size_t Size() const { return rob.size(); }
+    HMTTTransaction &Front() { return rob.front(); }
+    void Push(const HMTTTransaction &trans) {
+        rob.emplace_back(trans);
+        if (wait == rob.end()) wait--;
+    }
+    bool HasWaiting() const { return wait != rob.end(); }
+    HMTTTransaction &Waiting() { return *wait; }
+    bool WaitingDepends() const {
+        if (wait == rob.end()) return false;
+        for (auto i = rob.begin(); i != wait; ++i) {
+            if (i->addr == wait->addr) return true;
+        }
+        return false;
+    }
+    void Issue() { wait++; }
+    HMTTTransaction *FindIssuedRead(uint64_t addr) {
+        for (auto i = rob.begin(); i != wait; ++i) {
+            if (i->addr == addr && i->r_w == 1) return &*i;
+        }
+        return nullptr;
+    }
+    void Retire() {
+        for (auto i = rob.begin(); i != wait;) {
+            if (i->is_finished)
+                i = rob.erase(i);
+            else
+                break;
+        }
+    }
+
+   private:
+    std::list<HMTTTransaction> rob;
+    std::list<HMTTTransaction>::iterator wait;
+};
+
+struct Completion {
+    uint64_t clk;
+    uint64_t addr;
+    bool operator>(const Completion &c) const { return clk > c.clk; }
+};
+
+// HMTTCPU's issue loop against a fixed latency memory: one transaction
+// enters per cycle while the ROB holds fewer than `entries`, the oldest
+// waiting one issues unless an issued entry has its address or the MSHRs
+// are full. Returns a checksum of the issue order.
+template <typename ROB>
+uint64_t Run(ROB &rob, uint64_t cycles, uint64_t entries, uint64_t addresses,
+             uint64_t mshr, uint64_t seed, double &seconds) {
+    std::mt19937_64 gen(seed);
+    std::priority_queue<Completion, std::vector<Completion>, std::greater<Completion>> memory;
+    uint64_t outstanding = 0;
+    uint64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t clk = 0; clk < cycles; clk++) {
+        while (!memory.empty() && memory.top().clk <= clk) {
+            HMTTTransaction *res = rob.FindIssuedRead(memory.top().addr);
+            if (res == nullptr) {
+                std::cerr << "redundant read data " << memory.top().addr << "\n";
+                AbruptExit(__FILE__, __LINE__);
+            }
+            res->is_finished = true;
+            outstanding--;
+            rob.Retire();
+            memory.pop();
+        }
+        if (rob.Size() < entries) {
+            HMTTTransaction trans;
+            trans.addr = (gen() % addresses) << 6;
+            trans.r_w = gen() % 3 != 0;
+            trans.added_ns = clk;
+            trans.is_finished = false;
+            rob.Push(trans);
+        }
+        if (!rob.WaitingDepends() && outstanding < mshr && rob.HasWaiting()) {
+            HMTTTransaction &wait = rob.Waiting();
+            checksum = checksum * 31 + wait.addr + clk;
+            if (wait.r_w) {
+                memory.push(Completion{clk + 50 + gen() % 450, wait.addr});
+                outstanding++;
+                rob.Issue();
+            } else {
+                wait.is_finished = true;
+                rob.Issue();
+                rob.Retire();
+            }
+        }
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return checksum;
+}
+
+}  // namespace
+
+int main(int argc, const char **argv) {
+    args::ArgumentParser parser(
+        "Cycles per second of HMTTCPU's ROB, list-based against ReorderBuffer, "
+        "on a synthetic stream of transactions.",
+        "Examples: \n."
+        "./build/rob_bench -c 2000000 -e 512\n");
+    args::HelpFlag help(parser, "help", "Display the help menu", {'h', "help"});
+    args::ValueFlag<uint64_t> cycles_arg(parser, "cycles", "Cycles to simulate",
+                                         {'c', "cycles"}, 2000000);
+    args::ValueFlag<uint64_t> entries_arg(parser, "entries", "ROB entries",
+                                          {'e', "entries"}, 512);
+    args::ValueFlag<uint64_t> addresses_arg(parser, "addresses",
+                                            "Distinct cache lines accessed",
+                                            {'a', "addresses"}, 1 << 16);
+    args::ValueFlag<uint64_t> seed_arg(parser, "seed", "Seed of the stream",
+                                       {"seed"}, 1);
+
+    try {
+        parser.ParseCLI(argc, argv);
+    } catch (args::Help) {
+        std::cout << parser;
+        return 0;
+    } catch (args::ParseError e) {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+
+    uint64_t cycles = args::get(cycles_arg);
+    uint64_t entries = args::get(entries_arg);
+    uint64_t addresses = args::get(addresses_arg);
+    if (entries == 0 || addresses == 0) {
+        std::cerr << parser;
+        return 1;
+    }
+    const uint64_t mshr = 64;
+
+    double list_s, ring_s;
+    ListROB list_rob;
+    uint64_t list_sum = Run(list_rob, cycles, entries, addresses, mshr, args::get(seed_arg), list_s);
+    ReorderBuffer ring_rob(entries);
+    uint64_t ring_sum = Run(ring_rob, cycles, entries, addresses, mshr, args::get(seed_arg), ring_s);
+    if (list_sum != ring_sum) {
+        std::cerr << "ROBs issued in different orders" << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    std::cout << "list ROB:      " << cycles / list_s << " cycles/s\n"
+              << "ReorderBuffer: " << cycles / ring_s << " cycles/s\n"
+              << "speedup:       " << list_s / ring_s << "\n";
+    return 0;
+}
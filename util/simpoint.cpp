@@ -0,0 +1,129 @@
+#include "./../ext/headers/args.hxx"
+#include "../src/simpoint.h"
+#include <algorithm>
+#include <fstream>
+#include <limits>
+
+using namespace dramsim3;
+
+int main(int argc, const char **argv){
+    args::ArgumentParser parser(
+        "Cluster the window signatures (.sig) of trace_profile and pick one "
+        "representative window per cluster, writing <profile>.simpt for "
+        "dramsim3main -S.",
+        "Examples: \n."
+        "./build/simpoint ./output/ligra_bfs -k 20\n");
+    args::HelpFlag help(parser, "help", "Display the help menu", {'h', "help"});
+    args::ValueFlag<int> max_k_arg(parser, "max_k",
+                                   "Largest number of clusters tried",
+                                   {'k'}, 30);
+    args::ValueFlag<double> threshold_arg(parser, "threshold",
+                                          "Smallest k whose BIC reaches this fraction of the BIC range",
+                                          {'t'}, 0.9);
+    args::ValueFlag<uint64_t> seed_arg(parser, "seed", "Seed of k-means++",
+                                       {"seed"}, 1);
+    args::Positional<std::string> profile_arg(
+        parser, "profile", "Output prefix given to trace_profile (mandatory)");
+
+    try {
+        parser.ParseCLI(argc, argv);
+    } catch (args::Help) {
+        std::cout << parser;
+        return 0;
+    } catch (args::ParseError e) {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+
+    std::string profile = args::get(profile_arg);
+    int max_k = args::get(max_k_arg);
+    if (profile.empty() || max_k < 1) {
+        std::cerr << parser;
+        return 1;
+    }
+
+    std::ifstream sig_file(profile + ".sig");
+    if (sig_file.fail()) {
+        std::cerr << "signature file does not exist" << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    uint64_t num = 0;
+    sig_file>>num;
+    std::vector<WindowSignature> sigs(num);
+    uint64_t max_pages = 0;
+    for (auto &s : sigs) {
+        sig_file>>s;
+        max_pages = std::max(max_pages, s.pages);
+    }
+    if (sigs.empty() || sig_file.fail()) {
+        std::cerr << "no window signatures in " << profile << ".sig" << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    std::vector<std::vector<double>> points;
+    for (auto &s : sigs) {
+        points.push_back(s.Features(max_pages));
+    }
+
+    // SimPoint's rule: the smallest k that gets close to the best BIC
+    max_k = std::min<int>(max_k, sigs.size());
+    std::vector<double> bic;
+    for (int k = 1; k <= max_k; k++) {
+        bic.push_back(KMeans(points, k, args::get(seed_arg)).BIC());
+        std::cout<<"k = "<<k<<" BIC = "<<bic.back()<<"\n";
+    }
+    double lo = *std::min_element(bic.begin(), bic.end());
+    double hi = *std::max_element(bic.begin(), bic.end());
+    int k = 1;
+    while (k < max_k && bic[k - 1] < lo + args::get(threshold_arg) * (hi - lo)) {
+        k++;
+    }
+    KMeans kmeans(points, k, args::get(seed_arg));
+    const std::vector<int> &labels = kmeans.Labels();
+    const auto &centroids = kmeans.Centroids();
+
+    // representative: the window closest to its centroid
+    std::vector<SimPoint> simpts(centroids.size());
+    std::vector<double> best(centroids.size(), std::numeric_limits<double>::max());
+    std::vector<uint64_t> count(centroids.size(), 0);
+    for (size_t i = 0; i < points.size(); i++) {
+        int c = labels[i];
+        double d = 0;
+        for (size_t j = 0; j < points[i].size(); j++) {
+            d += (points[i][j] - centroids[c][j]) * (points[i][j] - centroids[c][j]);
+        }
+        count[c]++;
+        if (d < best[c]) {
+            best[c] = d;
+            simpts[c].sid = sigs[i].sid;
+            simpts[c].eid = sigs[i].eid;
+        }
+    }
+    // number clusters by footprint so that neighbours are alike, the error
+    // estimate pairs clusters in this order
+    std::vector<int> order;
+    for (size_t c = 0; c < centroids.size(); c++) {
+        if (count[c] > 0) order.push_back(c);
+    }
+    std::sort(order.begin(), order.end(), [&centroids](int a, int b) {
+        return centroids[a].back() < centroids[b].back();
+    });
+    std::vector<SimPoint> picked;
+    for (size_t i = 0; i < order.size(); i++) {
+        SimPoint p = simpts[order[i]];
+        p.weight = 1.0 * count[order[i]] / points.size();
+        p.cluster = i;
+        picked.push_back(p);
+    }
+    std::sort(picked.begin(), picked.end(), [](const SimPoint &a, const SimPoint &b) {
+        return a.sid < b.sid;
+    });
+
+    std::ofstream simpt_file(profile + ".simpt");
+    for (auto &p : picked) {
+        simpt_file<<p;
+    }
+    std::cout<<picked.size()<<" simulation points out of "<<sigs.size()
+             <<" windows written to "<<profile<<".simpt\n";
+    return 0;
+}
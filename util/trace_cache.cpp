@@ -0,0 +1,82 @@
+#include "./../ext/headers/args.hxx"
+#include "../src/trace.h"
+#include "../src/trace_cache.h"
+#include <sys/stat.h>
+
+using namespace dramsim3;
+
+static uint64_t FileSize(const std::string &path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? st.st_size : 0;
+}
+
+int main(int argc, const char **argv){
+    args::ArgumentParser parser(
+        "Translate an HMTT trace once into a trace cache (.htc).",
+        "Examples: \n."
+        "./build/trace_cache /mnt/hmtt/ligra_bfs \n"
+        "./build/trace_cache /mnt/hmtt/ligra_bfs -p 1000 -n 2\n");
+    args::HelpFlag help(parser, "help", "Display the help menu", {'h', "help"});
+    args::ValueFlag<int> pid_arg(parser, "pid",
+                                 "The pid of parent process, keep only its traces",
+                                 {'p'}, 0);
+    args::ValueFlag<uint64_t> num_process_arg(parser, "number_of_process",
+                                              "The number of process to keep, 0 keeps all",
+                                              {'n'}, 0);
+    args::ValueFlag<std::string> output_arg(parser, "output",
+                                            "Output file, <trace>.htc by default",
+                                            {'o'}, "");
+    args::Positional<std::string> trace_arg(
+        parser, "trace", "The trace file name (mandatory)");
+
+    try {
+        parser.ParseCLI(argc, argv);
+    } catch (args::Help) {
+        std::cout << parser;
+        return 0;
+    } catch (args::ParseError e) {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+
+    std::string trace_file = args::get(trace_arg);
+    if (trace_file.empty()) {
+        std::cerr << parser;
+        return 1;
+    }
+    std::string output = args::get(output_arg);
+    if (output.empty()) {
+        output = trace_file + ".htc";
+    }
+    int ppid = args::get(pid_arg);
+    uint64_t num_p = args::get(num_process_arg);
+
+    TraceCacheWriter writer;
+    if (!writer.Open(output, ppid, num_p, FileSize(trace_file + ".trace"),
+                     FileSize(trace_file + ".kt"))) {
+        std::cerr << "cannot create " << output << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+
+    TraceReader reader;
+    reader.Init((trace_file+".trace").c_str(), (trace_file+".kt").c_str());
+    const record_t &record = reader.Record();
+    uint64_t last_tm = 0;
+    while (reader.NextTranslate()) {
+        bool is_kernel = record.vaddr == 0 && record.pid == -1;
+        if (num_p != 0 && !is_kernel &&
+            (record.pid < ppid ||
+             record.pid >= static_cast<int>(ppid + num_p))) {
+            continue;
+        }
+        writer.Append((record.tm - last_tm) * 5, record.paddr, record.vaddr,
+                      record.pid, record.rw, is_kernel);
+        last_tm = record.tm;
+    }
+    writer.Close();
+    reader.Finish();
+    std::cout << std::dec << writer.NumRecords() << " records written to "
+              << output << "\n";
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include "./../ext/headers/args.hxx"
+#include "../src/trace_index.h"
+
+using namespace dramsim3;
+
+int main(int argc, const char **argv){
+    args::ArgumentParser parser(
+        "Build a seekable index (.hti) over an HMTT trace.",
+        "Examples: \n."
+        "./build/trace_index /mnt/hmtt/ligra_bfs 1000 -p 2 \n");
+    args::HelpFlag help(parser, "help", "Display the help menu", {'h', "help"});
+    args::ValueFlag<uint64_t> num_process_arg(parser, "number_of_process",
+                                              "The number of process to profile",
+                                              {'p'}, 16);
+    args::ValueFlag<uint64_t> interval_arg(parser, "interval",
+                                           "Trace ids between two snapshots",
+                                           {'i'}, 100000000);
+    args::ValueFlag<std::string> output_arg(parser, "output",
+                                            "Output file, <trace>.hti by default",
+                                            {'o'}, "");
+    args::Positional<std::string> trace_arg(
+        parser, "trace", "The trace file name (mandatory)");
+    args::Positional<int> pid_arg(
+        parser, "pid", "The pid of parent process (mandatory)");
+
+    try {
+        parser.ParseCLI(argc, argv);
+    } catch (args::Help) {
+        std::cout << parser;
+        return 0;
+    } catch (args::ParseError e) {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+
+    std::string trace_file = args::get(trace_arg);
+    uint64_t interval = args::get(interval_arg);
+    if (trace_file.empty() || interval == 0) {
+        std::cerr << parser;
+        return 1;
+    }
+    std::string output = args::get(output_arg);
+    if (output.empty()) {
+        output = trace_file + ".hti";
+    }
+
+    if (!TraceIndex::Build(trace_file, output, args::get(pid_arg),
+                           args::get(num_process_arg), interval)) {
+        AbruptExit(__FILE__, __LINE__);
+    }
+    return 0;
+}
@@ -0,0 +1,210 @@
+#include "./../ext/headers/args.hxx"
+#include "../src/trace_profile.h"
+#include "../src/trace_index.h"
+#include "../src/working_size.h"
+#include "../src/simpoint.h"
+#include <algorithm>
+#include <iomanip>
+#include <thread>
+
+using namespace dramsim3;
+
+int main(int argc, const char **argv){
+    args::ArgumentParser parser(
+        "Segment an HMTT trace and measure its working sets in one pass, "
+        "writing <output>.seg, <output>.ws and the window signatures "
+        "<output>.sig used by simpoint.",
+        "Examples: \n."
+        "./build/trace_profile /mnt/hmtt/ligra_bfs 1000 ./output/ligra_bfs -p 2 \n"
+        "./build/trace_profile /mnt/hmtt/ligra_bfs 1000 ./output/ligra_bfs -p 2 "
+        "--index /mnt/hmtt/ligra_bfs.hti -j 8\n");
+    args::HelpFlag help(parser, "help", "Display the help menu", {'h', "help"});
+    args::ValueFlag<uint64_t> num_process_arg(parser, "number_of_process",
+                                              "The number of process to profile",
+                                              {'p'}, 16);
+    args::ValueFlag<uint64_t> window_arg(parser, "window",
+                                         "Trace ids per working set window",
+                                         {'w'}, 10000000);
+    args::ValueFlag<uint64_t> period_arg(parser, "period",
+                                         "Trace time (ns) per footprint period",
+                                         {"period"}, 1000000000);
+    args::ValueFlag<uint64_t> min_length_arg(parser, "min_length",
+                                             "Shortest segment kept in .seg",
+                                             {'l'}, 1000000);
+    args::ValueFlag<uint64_t> signature_arg(parser, "signature",
+                                            "Buckets of the window signatures in .sig, 0 skips .sig",
+                                            {"signature"}, 16);
+    args::ValueFlag<std::string> index_arg(parser, "index",
+                                           "Seekable trace index (.hti), splits the trace into chunks",
+                                           {"index"});
+    args::ValueFlag<unsigned> threads_arg(parser, "threads",
+                                          "Chunks profiled in parallel, needs --index",
+                                          {'j'}, std::thread::hardware_concurrency());
+    args::Positional<std::string> trace_arg(
+        parser, "trace", "The trace file name (mandatory)");
+    args::Positional<int> pid_arg(
+        parser, "pid", "The pid of parent process (mandatory)");
+    args::Positional<std::string> output_arg(
+        parser, "output", "Output prefix of .seg, .ws and .sig (mandatory)");
+
+    try {
+        parser.ParseCLI(argc, argv);
+    } catch (args::Help) {
+        std::cout << parser;
+        return 0;
+    } catch (args::ParseError e) {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+
+    std::string trace_file = args::get(trace_arg);
+    std::string output = args::get(output_arg);
+    uint64_t window = args::get(window_arg);
+    uint64_t period = args::get(period_arg);
+    if (trace_file.empty() || output.empty() || window == 0 || period == 0) {
+        std::cerr << parser;
+        return 1;
+    }
+    int ppid = args::get(pid_arg);
+    uint64_t process = args::get(num_process_arg);
+    uint64_t min_length = args::get(min_length_arg);
+
+    // chunks start at index snapshots, the last one runs to the end
+    std::vector<TraceIndexEntry> starts(1, TraceIndexEntry{0, 0, 0});
+    std::string index_file = args::get(index_arg);
+    if (!index_file.empty()) {
+        TraceIndex index;
+        if (!index.Open(index_file)) {
+            AbruptExit(__FILE__, __LINE__);
+        }
+        if (index.Header().ppid != ppid || index.Header().num_p != process) {
+            std::cerr << index_file << " was built for pid " << index.Header().ppid
+                      << " -p " << index.Header().num_p << std::endl;
+            AbruptExit(__FILE__, __LINE__);
+        }
+        const std::vector<TraceIndexEntry> &entries = index.Entries();
+        uint64_t chunks = std::min<uint64_t>(std::max(args::get(threads_arg), 1u),
+                                             entries.size());
+        starts.clear();
+        for (uint64_t i = 0; i < chunks; i++) {
+            starts.push_back(entries[i * entries.size() / chunks]);
+        }
+    }
+
+    uint64_t dims = args::get(signature_arg);
+    TraceProfiler profiler(ppid, process, window, period, dims);
+    std::vector<TraceProfile> profiles(starts.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < starts.size(); i++) {
+        workers.emplace_back([&, i]() {
+            TraceReader reader;
+            reader.Init((trace_file+".trace").c_str(), (trace_file+".kt").c_str());
+            if (starts[i].id > 0) {
+                TraceIndex index;
+                if (!index.Open(index_file) || !index.Restore(reader, starts[i])) {
+                    AbruptExit(__FILE__, __LINE__);
+                }
+            }
+            uint64_t end = i + 1 < starts.size() ? starts[i + 1].id : UINT64_MAX;
+            profiler.Run(reader, starts[i].id, end, profiles[i]);
+            reader.Finish();
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+    TraceProfile &profile = profiles[0];
+    for (size_t i = 1; i < profiles.size(); i++) {
+        profile.Append(profiles[i]);
+    }
+
+    std::ofstream seg_file(output + ".seg");
+    seg_file<<"#"<<std::setw(15)<<"ppid"
+            <<std::setw(15)<<"#proc"
+            <<std::setw(15)<<"start id"
+            <<std::setw(15)<<"end id"
+            <<std::setw(15)<<"length"
+            <<std::setw(15)<<"ns"
+            <<std::setw(15)<<"#pages"
+            <<std::setw(15)<<"#read"
+            <<std::setw(15)<<"#write"
+            <<std::setw(15)<<"#kernel\n";
+    std::vector<seg> segs;
+    for (auto &s : profile.segments) {
+        if (s.length() > min_length && s.length() - s.kernel_num > min_length) {
+            segs.emplace_back(seg(s.sid, s.eid));
+            segs.back().time_span = s.time;
+            segs.back().r_num = s.r_num;
+            segs.back().w_num = s.w_num;
+            segs.back().kernel_num = s.kernel_num;
+            segs.back().pages_num = s.pages;
+            segs.back().pid = ppid;
+            segs.back().process_num = process;
+            seg_file<<segs.back();
+        }
+    }
+    uint64_t max_pages = 0;
+    for (auto &p : profile.periods) {
+        max_pages = std::max(max_pages, p.pages);
+    }
+    seg_file<<"#"<<std::setw(15)<<"#pages"
+            <<std::setw(15)<<"Bytes\n"
+            <<"#"<<std::dec<<std::setw(15)<<max_pages
+            <<std::setw(15)<<max_pages*4096
+            <<"\n";
+    for (auto &p : profile.pid_records) {
+        seg_file<<"#"<<p.first<<": "<<p.second<<"\n";
+    }
+
+    // full windows inside the segments kept above
+    std::vector<WorkingSet> wsets;
+    auto s = segs.begin();
+    for (auto &w : profile.windows) {
+        while (s != segs.end() && s->eid < w.eid) {
+            ++s;
+        }
+        if (s == segs.end()) {
+            break;
+        }
+        if (w.length() == window && s->sid <= w.sid) {
+            wsets.emplace_back(WorkingSet(w.sid, w.sid + window, w.pages));
+            wsets.back().time = w.time;
+        }
+    }
+    std::stable_sort(wsets.begin(), wsets.end(), std::greater<WorkingSet>());
+    std::ofstream ws_file(output + ".ws");
+    ws_file<<wsets.size()<<"\n";
+    for (auto &w : wsets) {
+        ws_file<<w;
+    }
+
+    if (dims > 0) {
+        std::vector<WindowSignature> sigs;
+        for (auto &w : profile.windows) {
+            if (w.length() == window) {
+                WindowSignature sig;
+                sig.sid = w.sid;
+                sig.eid = w.sid + window;
+                sig.pages = w.pages;
+                sig.r_num = w.r_num;
+                sig.w_num = w.w_num;
+                sig.accesses = w.accesses;
+                sig.footprint = w.footprint;
+                sigs.push_back(sig);
+            }
+        }
+        std::ofstream sig_file(output + ".sig");
+        sig_file<<sigs.size()<<"\n";
+        for (auto &sig : sigs) {
+            sig_file<<sig;
+        }
+    }
+
+    std::cout<<std::dec<<segs.size()<<" segments, "<<wsets.size()
+             <<" working set windows, max "<<max_pages<<" pages per period\n";
+    if (!wsets.empty()) {
+        std::cout<<"1/2 position: "<<wsets[wsets.size()/2];
+    }
+    return 0;
+}
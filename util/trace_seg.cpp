@@ -4,6 +4,7 @@
 
 #include "./../ext/headers/args.hxx"
 #include "trace_seg.h"
+#include "../src/trace.h"
 #include <iomanip>
 
 using namespace dramsim3;
@@ -43,7 +44,8 @@ int main(int argc, const char **argv){
     int ppid = args::get(pid_arg);
     std::unordered_map<int, uint64_t> num_traces_for_each_p;
 
-    trace_init((trace_file+".trace").c_str(), (trace_file+".kt").c_str());
+    TraceReader reader;
+    reader.Init((trace_file+".trace").c_str(), (trace_file+".kt").c_str());
     HMTTTransaction tmp;
     std::list<seg> segs;
     uint64_t id = 0, sid = 0;
@@ -55,7 +57,7 @@ int main(int argc, const char **argv){
     std::unordered_set<uint64_t> ppns;
     unsigned long max_ppns = 0;
 
-    GetNextHMTT(tmp, ppid, process);
+    reader.NextHMTT(tmp, ppid, process);
     period = tmp.added_ns;
     while(tmp.valid){
         if(tmp.added_ns > 1000000 && id > 0){
@@ -63,11 +65,11 @@ int main(int argc, const char **argv){
             segs.back().time_span = lasting;
             segs.back().w_num = w_num;
             segs.back().r_num = r_num;
-            segs.back().kernel_num = nonpte;
+            segs.back().kernel_num = reader.NonPTE();
             segs.back().pages_num = total_ppns.size();
             segs.back().pid = ppid;
             segs.back().process_num = process;
-            nonpte = 0;
+            reader.ResetNonPTE();
             sid = id;
             lasting = 0;
             w_num = 0;
@@ -89,7 +91,7 @@ int main(int argc, const char **argv){
         }
 
         id++;
-        GetNextHMTT(tmp, ppid, process);
+        reader.NextHMTT(tmp, ppid, process);
 
         period += tmp.added_ns;
         if(period < max_period){
@@ -103,7 +105,7 @@ int main(int argc, const char **argv){
         }
     }
 
-    trace_finish();
+    reader.Finish();
 
     std::cout<<"#"<<std::setw(15)<<"ppid"
             <<std::setw(15)<<"#proc"
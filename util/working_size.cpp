@@ -5,6 +5,7 @@
 #include "./../ext/headers/args.hxx"
 #include <iomanip>
 #include "../src/working_size.h"
+#include "../src/trace_index.h"
 
 using namespace dramsim3;
 
@@ -22,6 +23,9 @@ int main(int argc, const char **argv){
     args::ValueFlag<int64_t> start_arg(parser, "start",
                                              "start No. of trace",
                                              {'s'}, -1);
+    args::ValueFlag<std::string> index_arg(parser, "index",
+                                           "Seekable trace index (.hti) built by trace_index",
+                                           {"index"});
 
     try {
         parser.ParseCLI(argc, argv);
@@ -54,7 +58,12 @@ int main(int argc, const char **argv){
     workingset_file += ".ws";
     std::ofstream workingset_file_(workingset_file);
 
-    trace_init((trace_file+".trace").c_str(), (trace_file+".kt").c_str());
+    TraceReader reader;
+    reader.Init((trace_file+".trace").c_str(), (trace_file+".kt").c_str());
+    TraceIndex index;
+    if(index_arg && !index.Open(args::get(index_arg))){
+        AbruptExit(__FILE__, __LINE__);
+    }
     std::ifstream seg_file_(seg_file);
     if (seg_file_.fail()) {
         std::cerr << "Trace file does not exist" << std::endl;
@@ -89,8 +98,16 @@ int main(int argc, const char **argv){
         if(cur_seg.length() > simulation){
             std::cout<<std::dec<<"Next segment is at "<<sid<<"\n";
 
+            const TraceIndexEntry *e = index.IsOpen() ? index.Find(sid) : nullptr;
+            if(e != nullptr && e->id > id &&
+               index.Header().ppid == cur_seg.pid && index.Header().num_p == cur_seg.process_num){
+                if(!index.Restore(reader, *e)){
+                    AbruptExit(__FILE__, __LINE__);
+                }
+                id = e->id;
+            }
             while(id < sid){
-                GetNextHMTT(tmp, cur_seg.pid, cur_seg.process_num);
+                reader.NextHMTT(tmp, cur_seg.pid, cur_seg.process_num);
                 id++;
             }
 
@@ -98,7 +115,7 @@ int main(int argc, const char **argv){
             lasting = 0;
 
             while(id <= eid){
-                GetNextHMTT(tmp, cur_seg.pid, cur_seg.process_num);
+                reader.NextHMTT(tmp, cur_seg.pid, cur_seg.process_num);
                 if((id - last_id) < simulation){
                     ppns.insert(tmp.addr >> 12);
                     lasting += tmp.added_ns;